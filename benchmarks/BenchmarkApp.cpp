@@ -12,43 +12,95 @@
 
 #include <benchmarks/BenchmarkApp.hpp>
 
+#include <benchmarks/detail/CalibrationCache.hpp>
 #include <benchmarks/detail/Config.hpp>
+#include <benchmarks/detail/ParameterSweep.hpp>
+#include <benchmarks/detail/ResultsComparator.hpp>
+#include <benchmarks/detail/ResultsStore.hpp>
+#include <benchmarks/detail/SuiteLibrary.hpp>
+#include <benchmarks/utils/AllocationPolicy.hpp>
+#include <benchmarks/utils/ComplexityFit.hpp>
+#include <benchmarks/utils/ExecutionEnvironment.hpp>
+#include <benchmarks/utils/Json.hpp>
 #include <benchmarks/utils/Memory.hpp>
-#include <benchmarks/utils/ThreadPriority.hpp>
+#include <benchmarks/utils/Statistics.hpp>
+#include <benchmarks/utils/SystemMonitor.hpp>
+#include <benchmarks/utils/TscClock.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 
 
 namespace benchmarks
 {
 
-    using OperationTimesMap = std::map<std::string, double> ;
-    using MemoryConsumptionMap = std::map<std::string, int64_t>;
-
-
     class BenchmarksResultsReporter : public IBenchmarksResultsReporter
     {
     private:
         static NamedLogger      s_logger;
-        OperationTimesMap       _operationTimes;
-        MemoryConsumptionMap    _memoryConsumption;
+        BenchmarkResult         _result;
 
     public:
         virtual void ReportOperationDuration(const std::string& name, double ns)
         {
             s_logger.Debug() << name << ": " << ns << " ns";
-            _operationTimes[name] = ns;
+            _result.SetOperationTime(name, ns);
         }
 
         virtual void ReportMemoryConsumption(const std::string& name, int64_t bytes)
         {
             s_logger.Debug() << name << ": " << bytes << " bytes";
-            _memoryConsumption[name] = bytes;
+            _result.SetMemoryConsumption(name, bytes);
+        }
+
+        virtual void ReportMetric(const std::string& name, double value)
+        {
+            s_logger.Debug() << name << ": " << value;
+            _result.SetMetric(name, value);
         }
 
-        const OperationTimesMap& GetOperationTimes() const { return _operationTimes; }
-        const MemoryConsumptionMap& GetMemoryConsumption() const { return _memoryConsumption; }
+        virtual void ReportCounter(const std::string& name, const std::string& counter, double valuePerOperation)
+        {
+            s_logger.Debug() << name << "." << counter << ": " << valuePerOperation;
+            _result.SetCounter(name, counter, valuePerOperation);
+        }
+
+        virtual void ReportOperationStatistics(const std::string& name, const SampleStatistics& statistics)
+        {
+            s_logger.Debug() << name << ": median " << statistics.GetMedian() << " ns, " << statistics.GetSamples().size() << " samples, " << statistics.GetNumOutliers() << " outliers";
+            _result.SetStatistics(name, statistics);
+        }
+
+        virtual void ReportMemoryTimeline(const std::string& name, const MemoryTimeline& timeline)
+        {
+            s_logger.Debug() << name << ": " << timeline.size() << " memory timeline points";
+            _result.SetMemoryTimeline(name, timeline);
+        }
+
+        virtual void ReportLatencies(const std::string& name, const HdrHistogram& latencies)
+        {
+            s_logger.Debug() << name << ": p50 " << latencies.GetValueAtPercentile(50) << " ns, p99 " << latencies.GetValueAtPercentile(99) << " ns, max " << latencies.GetMax() << " ns";
+            _result.SetLatencies(name, latencies);
+        }
+
+        virtual void ReportWarning(const std::string& name, const std::string& message)
+        {
+            s_logger.Warning() << name << ": " << message;
+            _result.AddWarning(name, message);
+        }
+
+        const BenchmarkResult& GetResult() const { return _result; }
     };
     BENCHMARKS_LOGGER(BenchmarksResultsReporter);
 
@@ -80,6 +132,719 @@ namespace benchmarks
         template < typename String1_, typename... Strings_ >
         void SplitString(const std::string& src, char delim, String1_& dst1, Strings_&... dst)
         { SplitStringImpl(src, 0, delim, dst1, dst...); }
+
+
+        bool MatchGlob(const char* pattern, const char* str)
+        {
+            const char* star_pattern = nullptr;
+            const char* star_str = nullptr;
+            while (*str)
+            {
+                if (*pattern == '*')
+                {
+                    star_pattern = pattern++;
+                    star_str = str;
+                }
+                else if (*pattern == '?' || *pattern == *str)
+                {
+                    ++pattern;
+                    ++str;
+                }
+                else if (star_pattern)
+                {
+                    pattern = star_pattern + 1;
+                    str = ++star_str;
+                }
+                else
+                    return false;
+            }
+            while (*pattern == '*')
+                ++pattern;
+            return *pattern == '\0';
+        }
+
+
+        ParameterizedBenchmarkId MakeBenchmarkId(const std::string& benchmark, const SerializedParamsMap& params)
+        {
+            std::string className, benchmarkName, objectName;
+            SplitString(benchmark, '.', className, benchmarkName, objectName);
+
+            auto combinations = ParameterSweep(params).GetCombinations();
+            if (combinations.size() != 1)
+                throw std::runtime_error("Parameter sweeps are supported only by the runList subtask!");
+            return ParameterizedBenchmarkId({className, benchmarkName, objectName}, combinations.front());
+        }
+
+        std::vector<ParameterizedBenchmarkId> FindBenchmarks(const BenchmarkSuite& suite, const std::vector<std::string>& patterns, const ParameterSweep& sweep)
+        {
+            auto class_filter = [&](const std::string& className, const std::string& objectName)
+                {
+                    for (auto&& pattern : patterns)
+                    {
+                        if (std::count(pattern.begin(), pattern.end(), '.') != 2)
+                        {
+                            // A wildcard may span several components here, so only the literal prefix of the pattern is
+                            // known to belong to the class name
+                            auto pos = pattern.find_first_of(".*?");
+                            if (pos == std::string::npos)
+                                continue;
+                            if (pattern[pos] == '.' ? className == pattern.substr(0, pos) : className.compare(0, pos, pattern, 0, pos) == 0)
+                                return true;
+                            continue;
+                        }
+
+                        std::string class_pattern, benchmark_pattern, object_pattern;
+                        SplitString(pattern, '.', class_pattern, benchmark_pattern, object_pattern);
+                        if (MatchGlob(class_pattern.c_str(), className.c_str()) && MatchGlob(object_pattern.c_str(), objectName.c_str()))
+                            return true;
+                    }
+                    return false;
+                };
+
+            std::vector<ParameterizedBenchmarkId> result;
+            auto combinations = sweep.GetCombinations();
+            for (auto id : suite.GetBenchmarkIds(class_filter))
+            {
+                auto id_str = id.ToString();
+                for (auto&& pattern : patterns)
+                    if (MatchGlob(pattern.c_str(), id_str.c_str()))
+                    {
+                        for (auto&& params : combinations)
+                            result.push_back(ParameterizedBenchmarkId(id, params));
+                        break;
+                    }
+            }
+            return result;
+        }
+
+
+        bool ParseSweepValue(const SerializedParam& str, double& result)
+        {
+            size_t pos = 0;
+            try
+            { result = std::stod(str, &pos); }
+            catch (const std::exception&)
+            { return false; }
+            return pos == str.size() && result > 0;
+        }
+
+        std::vector<JsonValue> FitComplexities(const ParameterSweep& sweep, const std::vector<std::pair<ParameterizedBenchmarkId, JsonValue>>& results)
+        {
+            NamedLogger logger("FitComplexities");
+
+            std::vector<JsonValue> fits;
+            for (auto&& param : sweep.GetSweptParameters())
+            {
+                using Points = std::vector<std::pair<double, const JsonValue*>>;
+                std::map<ParameterizedBenchmarkId, Points> sweeps;
+
+                bool numeric = true;
+                for (auto&& r : results)
+                {
+                    if (!r.second.Has("times"))
+                        continue;
+
+                    auto params = r.first.GetParams();
+                    double n = 0;
+                    if (!(numeric = ParseSweepValue(params[param], n)))
+                        break;
+                    params[param] = sweep.GetSpecs().at(param);
+                    sweeps[ParameterizedBenchmarkId(r.first.GetId(), params)].push_back(std::make_pair(n, &r.second));
+                }
+
+                if (!numeric)
+                {
+                    logger.Info() << "Parameter " << param << " is not a positive number, skipping the complexity fit";
+                    continue;
+                }
+
+                for (auto&& s : sweeps)
+                {
+                    const Points& points = s.second;
+                    if (points.size() < 3)
+                        continue;
+
+                    JsonValue entry;
+                    entry["benchmark"] = s.first.ToString();
+                    entry["parameter"] = param;
+                    for (auto&& op : points.front().second->Get("times").AsObject())
+                    {
+                        std::vector<double> n, values;
+                        for (auto&& p : points)
+                            if (p.second->Get("times").Has(op.first))
+                            {
+                                n.push_back(p.first);
+                                values.push_back(p.second->Get("times").Get(op.first).AsNumber());
+                            }
+
+                        auto all_fits = FitAllComplexities(n, values);
+                        auto best = FindBestComplexityFit(all_fits);
+                        logger.Info() << s.first.ToString() << " " << op.first << ": " << ComplexityToString(best.complexity) << ", coefficient " << best.coefficient << ", rms " << best.rms * 100 << "%";
+
+                        JsonValue& fit = entry["complexity"][op.first];
+                        fit["best"] = ComplexityToString(best.complexity);
+                        fit["coefficient"] = best.coefficient;
+                        fit["rms"] = best.rms;
+                        for (auto&& f : all_fits)
+                        {
+                            JsonValue& model = fit["models"][ComplexityToString(f.complexity)];
+                            model["coefficient"] = f.coefficient;
+                            model["rms"] = f.rms;
+                        }
+                    }
+                    fits.push_back(entry);
+                }
+            }
+            return fits;
+        }
+
+
+        JsonValue ResultToJson(const BenchmarkResult& r)
+        {
+            JsonValue times = JsonValue::Object();
+            for (auto p : r.GetOperationTimes())
+                times[p.first] = p.second;
+
+            JsonValue memory = JsonValue::Object();
+            for (auto p : r.GetMemoryConsumption())
+                memory[p.first] = p.second;
+
+            JsonValue result;
+            result["times"] = times;
+            result["memory"] = memory;
+
+            if (!r.GetMetrics().empty())
+            {
+                JsonValue metrics = JsonValue::Object();
+                for (auto p : r.GetMetrics())
+                    metrics[p.first] = p.second;
+                result["metrics"] = metrics;
+            }
+
+            if (!r.GetCounters().empty())
+            {
+                JsonValue counters = JsonValue::Object();
+                for (auto p : r.GetCounters())
+                    for (auto c : p.second)
+                        counters[p.first][c.first] = c.second;
+                result["counters"] = counters;
+            }
+
+            if (!r.GetStatistics().empty())
+            {
+                JsonValue statistics = JsonValue::Object();
+                for (auto p : r.GetStatistics())
+                {
+                    const auto& st = p.second;
+                    JsonValue& entry = statistics[p.first];
+                    entry["median"] = st.GetMedian();
+                    entry["mean"] = st.GetMean();
+                    entry["stddev"] = st.GetStdDev();
+                    entry["mad"] = st.GetMad();
+                    entry["min"] = st.GetMin();
+                    entry["max"] = st.GetMax();
+                    entry["confidence"] = st.GetConfidence();
+                    entry["ci_low"] = st.GetCiLow();
+                    entry["ci_high"] = st.GetCiHigh();
+                    entry["outliers"] = (int64_t)st.GetNumOutliers();
+                    entry["samples"] = JsonValue::Array();
+                    for (double v : st.GetSamples())
+                        entry["samples"].Append(v);
+                }
+                result["statistics"] = statistics;
+            }
+
+            if (!r.GetMemoryTimelines().empty())
+            {
+                JsonValue timelines = JsonValue::Object();
+                for (auto p : r.GetMemoryTimelines())
+                {
+                    JsonValue& points = timelines[p.first];
+                    points = JsonValue::Array();
+                    for (auto&& point : p.second)
+                        points.Append(JsonValue::Array{ point.seconds, point.bytes });
+                }
+                result["memory_timelines"] = timelines;
+            }
+
+            if (!r.GetLatencies().empty())
+            {
+                JsonValue latencies = JsonValue::Object();
+                for (auto&& p : r.GetLatencies())
+                {
+                    const auto& h = p.second;
+                    JsonValue& entry = latencies[p.first];
+                    entry["count"] = h.GetTotalCount();
+                    entry["mean"] = h.GetMean();
+                    entry["min"] = h.GetMin();
+                    entry["p50"] = h.GetValueAtPercentile(50);
+                    entry["p90"] = h.GetValueAtPercentile(90);
+                    entry["p99"] = h.GetValueAtPercentile(99);
+                    entry["p99_9"] = h.GetValueAtPercentile(99.9);
+                    entry["max"] = h.GetMax();
+                    entry["histogram"] = JsonValue::Array();
+                    for (auto&& b : h.GetBuckets())
+                        entry["histogram"].Append(JsonValue::Array{ b.value, b.count });
+                }
+                result["latencies"] = latencies;
+            }
+
+            if (!r.GetWarnings().empty())
+            {
+                JsonValue warnings = JsonValue::Object();
+                for (auto&& p : r.GetWarnings())
+                {
+                    warnings[p.first] = JsonValue::Array();
+                    for (auto&& message : p.second)
+                        warnings[p.first].Append(message);
+                }
+                result["warnings"] = warnings;
+            }
+            return result;
+        }
+
+        JsonValue OverheadToJson(const MeasurementOverhead& overhead, bool subtracted)
+        {
+            JsonValue result;
+            result["scope_ns"] = overhead.scopeNs;
+            result["iteration_ns"] = overhead.iterationNs;
+            result["each_operation_ns"] = overhead.eachOperationNs;
+            result["subtracted"] = subtracted;
+            return result;
+        }
+
+        JsonValue AllocationToJson(const AllocationPolicy& requested)
+        {
+            JsonValue result;
+            result["requested"] = requested.ToJson();
+            result["used"] = MemoryBlock::GetUsedPolicies();
+            return result;
+        }
+
+
+        class BenchmarkRunner
+        {
+        private:
+            const BenchmarkSuite&               _suite;
+            std::unique_ptr<CalibrationCache>   _calibrationCache;
+            std::unique_ptr<ResultsStore>       _resultsStore;
+            std::string                         _revision;
+            JsonValue                           _environment;
+
+        public:
+            BenchmarkRunner(const BenchmarkSuite& suite, const std::string& calibrationCachePath, const std::string& resultsStorePath, std::string revision)
+                : _suite(suite), _revision(std::move(revision))
+            {
+                if (!calibrationCachePath.empty())
+                    _calibrationCache.reset(new CalibrationCache(calibrationCachePath));
+                if (!resultsStorePath.empty())
+                    _resultsStore.reset(new ResultsStore(resultsStorePath));
+            }
+
+            const BenchmarkSuite& GetSuite() const { return _suite; }
+
+            void SetEnvironment(JsonValue environment) { _environment = std::move(environment); }
+
+            int64_t MeasureIterationsCount(const ParameterizedBenchmarkId& id, const MeasurementOptions& options)
+            {
+                int64_t iterations = 0;
+                if (_calibrationCache && _calibrationCache->Find(id, iterations))
+                    return iterations;
+
+                Memory::ReleaseFreeMemory();
+                iterations = _suite.MeasureIterationsCount(id, options);
+                if (_calibrationCache)
+                    _calibrationCache->Store(id, iterations);
+                return iterations;
+            }
+
+            JsonValue InvokeBenchmark(int64_t iterations, const ParameterizedBenchmarkId& id, const MeasurementOptions& options)
+            {
+                Memory::ReleaseFreeMemory();
+                MemoryBlock::ResetUsedPolicies();
+                auto results_reporter = std::make_shared<BenchmarksResultsReporter>();
+                _suite.InvokeBenchmark(iterations, id, results_reporter, options);
+                StoreResult(id, results_reporter->GetResult());
+
+                JsonValue result = ResultToJson(results_reporter->GetResult());
+                result["overhead"] = OverheadToJson(_suite.GetMeasurementOverhead(options), options.subtractOverhead);
+                result["allocation"] = AllocationToJson(options.allocationPolicy);
+                if (!_environment.IsNull())
+                    result["environment"] = _environment;
+                return result;
+            }
+
+            JsonValue Run(const ParameterizedBenchmarkId& id, const MeasurementOptions& options)
+            {
+                auto results_reporter = std::make_shared<BenchmarksResultsReporter>();
+                int64_t iterations_count = 0;
+                Memory::ReleaseFreeMemory();
+                MemoryBlock::ResetUsedPolicies();
+                if (_calibrationCache && _calibrationCache->Find(id, iterations_count))
+                    _suite.InvokeBenchmark(iterations_count, id, results_reporter, options);
+                else
+                {
+                    iterations_count = _suite.MeasureAndInvokeBenchmark(id, results_reporter, options);
+                    if (_calibrationCache)
+                        _calibrationCache->Store(id, iterations_count);
+                }
+                StoreResult(id, results_reporter->GetResult());
+
+                JsonValue result = ResultToJson(results_reporter->GetResult());
+                result["benchmark"] = id.ToString();
+                result["iterations_count"] = iterations_count;
+                result["overhead"] = OverheadToJson(_suite.GetMeasurementOverhead(options), options.subtractOverhead);
+                result["allocation"] = AllocationToJson(options.allocationPolicy);
+                if (!_environment.IsNull())
+                    result["environment"] = _environment;
+                return result;
+            }
+
+        private:
+            void StoreResult(const ParameterizedBenchmarkId& id, const BenchmarkResult& result)
+            {
+                if (_resultsStore)
+                    _resultsStore->Append(id, result, _revision, _environment.IsNull() ? std::string() : _environment.ToString());
+            }
+        };
+
+
+        // Hash of the environment without the values that change from run to run
+        std::string EnvironmentFingerprint(const std::string& environment)
+        {
+            std::string stable = environment;
+            try
+            {
+                JsonValue env = JsonValue::Parse(environment);
+                if (env.Has("system"))
+                {
+                    static const std::set<std::string> volatile_keys = { "cpu", "frequency_khz", "interrupts", "issues", "jitter", "load_average" };
+                    JsonValue system = JsonValue::Object();
+                    for (auto&& p : env.Get("system").AsObject())
+                        if (volatile_keys.find(p.first) == volatile_keys.end())
+                            system[p.first] = p.second;
+                    if (system.Has("clock")) // the calibrated TSC frequency is printed in parentheses
+                        system["clock"] = system.Get("clock").AsString().substr(0, system.Get("clock").AsString().find(" ("));
+                    env["system"] = system;
+                }
+                stable = env.ToString();
+            }
+            catch (const std::exception&)
+            { }
+
+            uint64_t hash = 14695981039346656037ULL;
+            for (char c : stable)
+            {
+                hash ^= (unsigned char)c;
+                hash *= 1099511628211ULL;
+            }
+
+            std::stringstream s;
+            s << std::hex << std::setw(16) << std::setfill('0') << hash;
+            return s.str();
+        }
+
+        std::vector<ResultsRecord> ReadResults(const std::string& path, const std::vector<std::string>& patterns)
+        {
+            return ResultsStore(path).Read([&](const ResultsRecord& r)
+                {
+                    auto measurement_id = r.GetMeasurementId();
+                    for (auto&& pattern : patterns)
+                        if (MatchGlob(pattern.c_str(), r.benchmark.c_str()) || MatchGlob(pattern.c_str(), measurement_id.c_str()))
+                            return true;
+                    return false;
+                });
+        }
+
+        void PrintHistory(const std::vector<ResultsRecord>& records, std::ostream& out)
+        {
+            for (auto&& r : records)
+            {
+                JsonValue entry;
+                entry["measurement"] = r.GetMeasurementId();
+                entry["timestamp"] = r.timestamp;
+                entry["revision"] = r.revision;
+                entry["value"] = r.value;
+                entry["samples"] = (int64_t)r.samples.size();
+                if (!r.samples.empty())
+                {
+                    auto minmax = std::minmax_element(r.samples.begin(), r.samples.end());
+                    entry["min"] = *minmax.first;
+                    entry["max"] = *minmax.second;
+                }
+                entry["environment"] = EnvironmentFingerprint(r.environment);
+                out << entry.ToString() << std::endl;
+            }
+        }
+
+        void PrintChangepoints(const std::vector<ResultsRecord>& records, double minChange, std::ostream& out)
+        {
+            const size_t min_segment_size = 3;
+
+            std::map<std::string, std::vector<const ResultsRecord*>> series;
+            for (auto&& r : records)
+                series[r.GetMeasurementId()].push_back(&r);
+
+            for (auto&& s : series)
+            {
+                const auto& points = s.second;
+                std::vector<double> log_values;
+                for (auto r : points)
+                    log_values.push_back(std::log(std::max(r->value, 1e-12)));
+
+                // BIC-like penalty
+                auto changepoints = DetectChangepoints(log_values, 2 * std::log((double)points.size()), min_segment_size);
+                for (size_t i = 0; i < changepoints.size(); ++i)
+                {
+                    size_t begin = i == 0 ? 0 : changepoints[i - 1];
+                    size_t cp = changepoints[i];
+                    size_t end = i + 1 < changepoints.size() ? changepoints[i + 1] : points.size();
+
+                    std::vector<double> before, after;
+                    for (size_t j = begin; j < cp; ++j)
+                        before.push_back(points[j]->value);
+                    for (size_t j = cp; j < end; ++j)
+                        after.push_back(points[j]->value);
+
+                    double before_median = Median(before), after_median = Median(after);
+                    double change = before_median != 0 ? after_median / before_median - 1 : 0;
+                    if (std::fabs(change) < minChange)
+                        continue;
+
+                    JsonValue entry;
+                    entry["measurement"] = s.first;
+                    entry["index"] = (int64_t)cp;
+                    entry["timestamp"] = points[cp]->timestamp;
+                    entry["revision"] = points[cp]->revision;
+                    entry["previous_revision"] = points[cp - 1]->revision;
+                    entry["before"] = before_median;
+                    entry["after"] = after_median;
+                    entry["change"] = change;
+                    entry["environment_changed"] = EnvironmentFingerprint(points[cp]->environment) != EnvironmentFingerprint(points[cp - 1]->environment);
+                    out << entry.ToString() << std::endl;
+                }
+            }
+        }
+
+
+        SerializedParamsMap ParamsFromJson(const JsonValue& request)
+        {
+            SerializedParamsMap params;
+            if (!request.Has("params"))
+                return params;
+
+            for (auto p : request.Get("params").AsObject())
+                params[p.first] = p.second.GetType() == JsonValue::Type::String ? p.second.AsString() : p.second.ToString();
+            return params;
+        }
+
+        MeasurementOptions OptionsFromJson(const JsonValue& request, MeasurementOptions options)
+        {
+            if (request.Has("perf_counters"))
+                options.perfCounters = request.Get("perf_counters").AsBool();
+            if (request.Has("samples"))
+                options.samples = (int)request.Get("samples").AsInt();
+            if (request.Has("outliers"))
+                options.outlierRule = OutlierRule::Parse(request.Get("outliers").AsString());
+            if (request.Has("confidence"))
+                options.confidence = request.Get("confidence").AsNumber();
+            if (request.Has("bootstrap"))
+                options.bootstrapResamples = (int)request.Get("bootstrap").AsInt();
+            if (request.Has("memory_source"))
+                options.memorySource = ParseMemorySource(request.Get("memory_source").AsString());
+            if (request.Has("noise_policy"))
+                options.noisePolicy = ParseNoisePolicy(request.Get("noise_policy").AsString());
+            if (request.Has("max_frequency_drift"))
+                options.maxFrequencyDrift = request.Get("max_frequency_drift").AsNumber() / 100;
+            if (request.Has("memory_timeline_interval"))
+                options.memoryTimelineInterval = std::chrono::microseconds(request.Get("memory_timeline_interval").AsInt());
+            if (request.Has("subtract_overhead"))
+                options.subtractOverhead = request.Get("subtract_overhead").AsBool();
+            if (request.Has("allocation_policy"))
+                options.allocationPolicy = AllocationPolicy::Parse(request.Get("allocation_policy").AsString());
+            return options;
+        }
+
+        JsonValue OptionsToJson(const MeasurementOptions& options)
+        {
+            JsonValue result;
+            result["perf_counters"] = options.perfCounters;
+            result["samples"] = options.samples;
+            result["outliers"] = options.outlierRule.ToString();
+            result["confidence"] = options.confidence;
+            result["bootstrap"] = options.bootstrapResamples;
+            if (options.memorySource != MemorySource::Default)
+                result["memory_source"] = MemorySourceToString(options.memorySource);
+            result["noise_policy"] = NoisePolicyToString(options.noisePolicy);
+            result["max_frequency_drift"] = options.maxFrequencyDrift * 100;
+            result["memory_timeline_interval"] = (int64_t)options.memoryTimelineInterval.count();
+            result["subtract_overhead"] = options.subtractOverhead;
+            result["allocation_policy"] = options.allocationPolicy.ToString();
+            return result;
+        }
+
+        ComparisonOptions ComparisonOptionsFromJson(const JsonValue& request, ComparisonOptions options)
+        {
+            if (request.Has("alpha"))
+                options.alpha = request.Get("alpha").AsNumber();
+            if (request.Has("min_effect"))
+                options.minEffect = request.Get("min_effect").AsNumber() / 100;
+            if (request.Has("confidence"))
+                options.confidence = request.Get("confidence").AsNumber();
+            if (request.Has("bootstrap"))
+                options.bootstrapResamples = (int)request.Get("bootstrap").AsInt();
+            return options;
+        }
+
+        ResultsComparator::SamplesMap SamplesFromJson(const JsonValue& results)
+        {
+            ResultsComparator::SamplesMap samples;
+            for (auto&& r : results.AsArray())
+                ResultsComparator::CollectSamples(r, samples);
+            return samples;
+        }
+
+        std::map<std::string, ResultsComparator::SamplesMap> ReadResultsFile(const std::string& path)
+        {
+            std::ifstream f(path);
+            if (!f)
+                throw std::runtime_error("Could not open " + path);
+
+            std::map<std::string, ResultsComparator::SamplesMap> result;
+            std::string line;
+            while (std::getline(f, line))
+            {
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+                JsonValue r = JsonValue::Parse(line);
+                if (r.Has("benchmark") && r.Has("times"))
+                    ResultsComparator::CollectSamples(r, result[r.Get("benchmark").AsString()]);
+            }
+            return result;
+        }
+
+        JsonValue HandleServerRequest(BenchmarkRunner& runner, const JsonValue& request, const MeasurementOptions& defaultOptions)
+        {
+            auto subtask = request.Get("subtask").AsString();
+
+            if (subtask == "compare")
+            {
+                ResultsComparator comparator(ComparisonOptionsFromJson(request, ComparisonOptions()));
+                JsonValue result;
+                result["metrics"] = ResultsComparator::ToJson(comparator.Compare(SamplesFromJson(request.Get("reference")), SamplesFromJson(request.Get("current"))));
+                return result;
+            }
+
+            if (subtask == "list")
+            {
+                std::vector<std::string> patterns;
+                for (auto&& p : request.Get("benchmarks").AsArray())
+                    patterns.push_back(p.AsString());
+
+                JsonValue result;
+                result["benchmarks"] = JsonValue::Array();
+                for (auto&& id : FindBenchmarks(runner.GetSuite(), patterns, ParameterSweep(ParamsFromJson(request))))
+                    result["benchmarks"].Append(id.ToString());
+                return result;
+            }
+
+            auto id = MakeBenchmarkId(request.Get("benchmark").AsString(), ParamsFromJson(request));
+            auto options = OptionsFromJson(request, defaultOptions);
+
+            if (subtask == "measureIterationsCount")
+            {
+                JsonValue result;
+                result["iterations_count"] = runner.MeasureIterationsCount(id, options);
+                return result;
+            }
+            else if (subtask == "invokeBenchmark")
+                return runner.InvokeBenchmark(request.Get("iterations").AsInt(), id, options);
+            else if (subtask == "run")
+                return runner.Run(id, options);
+            else
+                throw std::runtime_error("Unknown subtask: " + subtask);
+        }
+
+        JsonValue RunInterleaved(const SuiteLibrary& reference, const SuiteLibrary& current, const ParameterizedBenchmarkId& id, int64_t iterations, int passes, const MeasurementOptions& options, const ComparisonOptions& comparisonOptions)
+        {
+            JsonValue request = OptionsToJson(options);
+            request["worker_cpus"] = JsonValue::Array();
+            for (int cpu : ExecutionEnvironment::GetWorkerCpus())
+                request["worker_cpus"].Append(cpu);
+            if (TscClock::IsReliable())
+                request["ns_per_tick"] = TscClock::GetNanosecondsPerTick();
+            request["benchmark"] = id.GetId().ToString();
+            request["params"] = JsonValue::Object();
+            for (auto&& p : id.GetParams())
+                request["params"][p.first] = p.second;
+
+            if (iterations < 0)
+            {
+                request["subtask"] = "measureIterationsCount";
+                iterations = current.Request(request).Get("iterations_count").AsInt();
+            }
+
+            request["subtask"] = "invokeBenchmark";
+            request["iterations"] = iterations;
+
+            // The first invocations only warm up the caches and the allocators of both builds
+            reference.Request(request);
+            current.Request(request);
+
+            ResultsComparator::SamplesMap reference_samples, current_samples;
+            for (int i = 0; i < passes; ++i)
+            {
+                bool reference_first = (i % 2 == 0);
+                const SuiteLibrary& first = reference_first ? reference : current;
+                const SuiteLibrary& second = reference_first ? current : reference;
+
+                JsonValue first_result = first.Request(request);
+                JsonValue second_result = second.Request(request);
+                ResultsComparator::CollectSamples(first_result, reference_first ? reference_samples : current_samples);
+                ResultsComparator::CollectSamples(second_result, reference_first ? current_samples : reference_samples);
+            }
+
+            JsonValue result;
+            result["benchmark"] = id.ToString();
+            result["reference"] = reference.GetPath();
+            result["current"] = current.GetPath();
+            result["iterations_count"] = iterations;
+            result["passes"] = passes;
+            result["metrics"] = ResultsComparator::ToJson(ResultsComparator(comparisonOptions).ComparePaired(reference_samples, current_samples));
+            return result;
+        }
+
+        void Serve(BenchmarkRunner& runner, const MeasurementOptions& options, std::istream& in, std::ostream& out)
+        {
+            NamedLogger logger("Serve");
+
+            std::string line;
+            while (std::getline(in, line))
+            {
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+
+                JsonValue response;
+                try
+                {
+                    JsonValue request = JsonValue::Parse(line);
+                    if (request.Get("subtask").AsString() == "exit")
+                        break;
+
+                    response = HandleServerRequest(runner, request, options);
+                    if (request.Has("id"))
+                        response["id"] = request.Get("id");
+                }
+                catch (const std::exception& ex)
+                {
+                    logger.Warning() << "Request failed: " << ex.what();
+                    response = JsonValue();
+                    response["error"] = ex.what();
+                }
+
+                out << response.ToString() << std::endl;
+            }
+        }
     }
 
 
@@ -92,9 +857,24 @@ namespace benchmarks
 #if BENCHMARKS_CFG_DEBUG
             throw CmdLineException("You are trying to run the debug build of benchmarks. This is a bad idea. :)");
 #endif
-            std::string subtask, benchmark;
+            std::string subtask;
             int64_t num_iterations = -1;
             int64_t verbosity = 1;
+            std::string calibration_cache_path;
+            std::string results_store_path;
+            const char* revision_env = std::getenv("BENCHMARKS_REVISION");
+            std::string revision = revision_env ? revision_env : "";
+            double min_change = 0.05;
+            std::string reference_results_path, current_results_path;
+            std::string reference_library_path, current_library_path;
+            int num_passes = 20;
+            ComparisonOptions comparison_options;
+            MeasurementOptions options;
+            ExecutionEnvironmentOptions environment_options;
+            std::chrono::milliseconds jitter_check_duration(100);
+            std::chrono::nanoseconds jitter_threshold(std::chrono::microseconds(10));
+            bool forbid_turbo = false;
+            std::vector<std::string> benchmarks_vec;
             std::vector<std::string> params_vec;
 
             for (int i = 1; i < argc; ++i)
@@ -111,13 +891,75 @@ namespace benchmarks
                         subtask.assign(val);
                     else if (arg == "--verbosity")
                         verbosity = stoll(val);
+                    else if (arg == "--calibration-cache")
+                        calibration_cache_path.assign(val);
+                    else if (arg == "--results-store")
+                        results_store_path.assign(val);
+                    else if (arg == "--revision")
+                        revision.assign(val);
+                    else if (arg == "--min-change")
+                        min_change = stod(val) / 100;
+                    else if (arg == "--reference-results")
+                        reference_results_path.assign(val);
+                    else if (arg == "--current-results")
+                        current_results_path.assign(val);
+                    else if (arg == "--reference-library")
+                        reference_library_path.assign(val);
+                    else if (arg == "--current-library")
+                        current_library_path.assign(val);
+                    else if (arg == "--passes")
+                        num_passes = stoi(val);
+                    else if (arg == "--alpha")
+                        comparison_options.alpha = stod(val);
+                    else if (arg == "--min-effect")
+                        comparison_options.minEffect = stod(val) / 100;
                     else if (arg == "--iterations")
                         num_iterations = stoll(val);
+                    else if (arg == "--perf-counters")
+                        options.perfCounters = (stoll(val) != 0);
+                    else if (arg == "--samples")
+                        options.samples = stoi(val);
+                    else if (arg == "--outliers")
+                        options.outlierRule = OutlierRule::Parse(val);
+                    else if (arg == "--confidence")
+                        options.confidence = stod(val);
+                    else if (arg == "--bootstrap")
+                        options.bootstrapResamples = stoi(val);
+                    else if (arg == "--memory-source")
+                        options.memorySource = ParseMemorySource(val);
+                    else if (arg == "--noise-policy")
+                        options.noisePolicy = ParseNoisePolicy(val);
+                    else if (arg == "--max-frequency-drift")
+                        options.maxFrequencyDrift = stod(val) / 100;
+                    else if (arg == "--jitter-check")
+                        jitter_check_duration = std::chrono::milliseconds(stoll(val));
+                    else if (arg == "--jitter-threshold")
+                        jitter_threshold = std::chrono::microseconds(stoll(val));
+                    else if (arg == "--forbid-turbo")
+                        forbid_turbo = (stoll(val) != 0);
+                    else if (arg == "--cpus")
+                        environment_options.cpus = ExecutionEnvironment::ParseCpuList(val);
+                    else if (arg == "--numa-node")
+                        environment_options.numaNode = stoi(val);
+                    else if (arg == "--mlock")
+                        environment_options.lockMemory = (stoll(val) != 0);
+                    else if (arg == "--prefault")
+                        environment_options.prefaultBytes = stoll(val) * 1024 * 1024;
+                    else if (arg == "--disable-malloc-mmap")
+                        environment_options.disableMallocMmap = (stoll(val) != 0);
+                    else if (arg == "--realtime-priority")
+                        environment_options.realtimePriority = (stoll(val) != 0);
+                    else if (arg == "--memory-timeline-interval")
+                        options.memoryTimelineInterval = std::chrono::microseconds(stoll(val));
+                    else if (arg == "--subtract-overhead")
+                        options.subtractOverhead = (stoll(val) != 0);
+                    else if (arg == "--allocation-policy")
+                        options.allocationPolicy = AllocationPolicy::Parse(val);
                 }
                 else
                 {
-                    if (benchmark.empty())
-                        benchmark = arg;
+                    if (arg.find(':') == std::string::npos)
+                        benchmarks_vec.push_back(arg);
                     else
                         params_vec.push_back(arg);
                 }
@@ -125,8 +967,6 @@ namespace benchmarks
 
             if (subtask.empty())
                 throw CmdLineException("subtask not specified");
-            if (benchmark.empty())
-                throw CmdLineException("benchmark not specified");
 
             switch (verbosity)
             {
@@ -138,58 +978,150 @@ namespace benchmarks
             default: logger.Warning() << "Unexpected verbosity value: " << verbosity; break;
             }
 
-            if (!benchmark.empty())
+            logger.Verbose() << "Profiler clock: " << TscClock::GetDescription();
+
+            SerializedParamsMap params;
+            for (auto&& param_str : params_vec)
             {
-                std::string className, benchmarkName, objectName;
-                SplitString(benchmark, '.', className, benchmarkName, objectName);
+                std::string name, value;
+                SplitString(param_str, ':', name, value);
+                params[name] = value;
+            }
 
-                std::map<std::string, SerializedParam> params;
-                for (auto&& param_str : params_vec)
-                {
-                    std::string name, value;
-                    SplitString(param_str, ':', name, value);
-                    params[name] = value;
-                }
+            if (subtask == "history" || subtask == "changepoints")
+            {
+                if (results_store_path.empty())
+                    throw CmdLineException("Results store is not specified!");
+                if (benchmarks_vec.empty())
+                    benchmarks_vec.push_back("*");
+
+                auto records = ReadResults(results_store_path, benchmarks_vec);
+                if (subtask == "history")
+                    PrintHistory(records, std::cout);
+                else
+                    PrintChangepoints(records, min_change, std::cout);
+                return 0;
+            }
 
-                ParameterizedBenchmarkId benchmark_id({className, benchmarkName, objectName}, params);
+            if (subtask == "compare")
+            {
+                if (reference_results_path.empty() || current_results_path.empty())
+                    throw CmdLineException("Both --reference-results and --current-results must be specified!");
+
+                auto reference = ReadResultsFile(reference_results_path);
+                auto current = ReadResultsFile(current_results_path);
+                ResultsComparator comparator(comparison_options);
 
-                if (subtask == "measureIterationsCount")
+                int num_regressions = 0;
+                for (auto&& r : reference)
                 {
-                    auto iterations_count = suite.MeasureIterationsCount(benchmark_id);
-                    std::cout << "{\"iterations_count\":" << iterations_count << "}" << std::endl;
-                    return 0;
+                    auto it = current.find(r.first);
+                    if (it == current.end())
+                        continue;
+
+                    auto comparisons = comparator.Compare(r.second, it->second);
+                    for (auto&& c : comparisons)
+                        if (c.verdict == ComparisonVerdict::Regression)
+                        {
+                            logger.Warning() << r.first << " " << c.metric << ": " << c.referenceMedian << " -> " << c.currentMedian << " (" << c.effect * 100 << "%, p = " << c.adjustedPValue << ")";
+                            ++num_regressions;
+                        }
+
+                    JsonValue result;
+                    result["benchmark"] = r.first;
+                    result["metrics"] = ResultsComparator::ToJson(comparisons);
+                    std::cout << result.ToString() << std::endl;
                 }
-                else if (subtask == "invokeBenchmark")
+                return num_regressions == 0 ? 0 : 1;
+            }
+
+            BenchmarkRunner runner(suite, calibration_cache_path, results_store_path, revision);
+            ExecutionEnvironment environment(environment_options);
+            auto apply_environment = [&]
                 {
-                    if (num_iterations < 0)
-                        throw CmdLineException("Number of iterations is not specified!");
-                    SetMaxThreadPriority();
-                    auto results_reporter = std::make_shared<BenchmarksResultsReporter>();
-                    suite.InvokeBenchmark(num_iterations, benchmark_id, results_reporter);
-                    auto r = BenchmarkResult(results_reporter->GetOperationTimes(), results_reporter->GetMemoryConsumption());
+                    environment.Apply();
+                    JsonValue environment_json = environment.ToJson();
+                    environment_json["system"] = SystemMonitor::RunPreflight(options.noisePolicy, jitter_check_duration, jitter_threshold, forbid_turbo);
+                    runner.SetEnvironment(environment_json);
+                };
+
+            if (subtask == "serve")
+            {
+                apply_environment();
+                Serve(runner, options, std::cin, std::cout);
+                return 0;
+            }
 
-                    const auto& times = r.GetOperationTimes();
-                    const auto& memory = r.GetMemoryConsumption();
+            if (subtask == "runList")
+            {
+                if (benchmarks_vec.empty())
+                    benchmarks_vec.push_back("*");
+
+                ParameterSweep sweep(params);
+                auto ids = FindBenchmarks(suite, benchmarks_vec, sweep);
+                if (ids.empty())
+                    throw CmdLineException("No benchmarks match the specified patterns!");
 
-                    std::cout << "{" << std::endl;
-                    std::cout << "  \"times\": {" << std::endl;
-                    for (auto it = times.begin(); it != times.end(); ++it)
-                        std::cout << "    \"" << it->first << "\": " << it->second << (std::next(it) == times.end() ? "" : ",") << std::endl;
-                    std::cout << "  }," << std::endl;
-                    std::cout << "  \"memory\": {" << std::endl;
-                    for (auto it = memory.begin(); it != memory.end(); ++it)
-                        std::cout << "    \"" << it->first << "\": " << it->second << (std::next(it) == memory.end() ? "" : ",") << std::endl;
-                    std::cout << "  }" << std::endl;
-                    std::cout << "}" << std::endl;
-                    return 0;
+                apply_environment();
+                int num_errors = 0;
+                std::vector<std::pair<ParameterizedBenchmarkId, JsonValue>> results;
+                for (auto&& id : ids)
+                {
+                    JsonValue result;
+                    try
+                    { result = runner.Run(id, options); }
+                    catch (const std::exception& ex)
+                    {
+                        logger.Error() << id.ToString() << ": " << ex.what();
+                        ++num_errors;
+                        result = JsonValue();
+                        result["benchmark"] = id.ToString();
+                        result["error"] = ex.what();
+                    }
+                    std::cout << result.ToString() << std::endl;
+                    results.push_back(std::make_pair(id, result));
                 }
-                else
-                    throw CmdLineException("Unknown subtask!");
+
+                for (auto&& fit : FitComplexities(sweep, results))
+                    std::cout << fit.ToString() << std::endl;
+                return num_errors == 0 ? 0 : 1;
             }
-            else
-                throw CmdLineException("Benchmark not specified!");
 
-            return 0;
+            if (benchmarks_vec.empty())
+                throw CmdLineException("benchmark not specified");
+            if (benchmarks_vec.size() > 1)
+                throw CmdLineException("Too many benchmarks specified, use the runList subtask to run several benchmarks!");
+
+            auto benchmark_id = MakeBenchmarkId(benchmarks_vec.front(), params);
+
+            if (subtask == "measureIterationsCount")
+            {
+                auto iterations_count = runner.MeasureIterationsCount(benchmark_id, options);
+                std::cout << "{\"iterations_count\":" << iterations_count << "}" << std::endl;
+                return 0;
+            }
+            else if (subtask == "invokeBenchmark")
+            {
+                if (num_iterations < 0)
+                    throw CmdLineException("Number of iterations is not specified!");
+                apply_environment();
+                std::cout << runner.InvokeBenchmark(num_iterations, benchmark_id, options).ToString(true) << std::endl;
+                return 0;
+            }
+            else if (subtask == "interleave")
+            {
+                if (reference_library_path.empty() || current_library_path.empty())
+                    throw CmdLineException("Both --reference-library and --current-library must be specified!");
+
+                SuiteLibrary reference(reference_library_path), current(current_library_path);
+                apply_environment();
+                JsonValue result = RunInterleaved(reference, current, benchmark_id, num_iterations, num_passes, options, comparison_options);
+                result["environment"] = environment.ToJson();
+                std::cout << result.ToString(true) << std::endl;
+                return 0;
+            }
+            else
+                throw CmdLineException("Unknown subtask!");
         }
         catch (const CmdLineException& ex)
         {
@@ -203,4 +1135,54 @@ namespace benchmarks
         }
     }
 
+
+    int RunBenchmarkApp(int argc, const char* argv[])
+    {
+        BenchmarkSuite suite;
+        suite.RegisterStaticBenchmarks();
+        return RunBenchmarkApp(suite, argc, argv);
+    }
+
+
+    namespace detail
+    {
+        char* HandleSuiteLibraryRequest(const char* request)
+        {
+            static BenchmarkSuite suite;
+            static BenchmarkRunner runner(suite, std::string(), std::string(), std::string());
+            static std::once_flag registered;
+            std::call_once(registered, [] { suite.RegisterStaticBenchmarks(); });
+
+            JsonValue response;
+            try
+            {
+                JsonValue parsed_request = JsonValue::Parse(request);
+                if (parsed_request.Has("worker_cpus"))
+                {
+                    std::vector<int> cpus;
+                    for (auto&& cpu : parsed_request.Get("worker_cpus").AsArray())
+                        cpus.push_back((int)cpu.AsInt());
+                    ExecutionEnvironment::SetWorkerCpus(cpus);
+                }
+                if (parsed_request.Has("ns_per_tick"))
+                    TscClock::UseNanosecondsPerTick(parsed_request.Get("ns_per_tick").AsNumber());
+                response = HandleServerRequest(runner, parsed_request, MeasurementOptions());
+            }
+            catch (const std::exception& ex)
+            {
+                response = JsonValue();
+                response["error"] = ex.what();
+            }
+
+            std::string response_str = response.ToString();
+            char* result = (char*)std::malloc(response_str.size() + 1);
+            if (result)
+                std::memcpy(result, response_str.c_str(), response_str.size() + 1);
+            return result;
+        }
+
+        void FreeSuiteLibraryString(char* str)
+        { std::free(str); }
+    }
+
 }
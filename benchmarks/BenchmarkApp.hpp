@@ -21,6 +21,31 @@ namespace benchmarks
 
     int RunBenchmarkApp(const BenchmarkSuite& suite, int argc, const char* argv[]);
 
+    // Runs the benchmarks registered with BENCHMARKS_REGISTER_CLASS
+    int RunBenchmarkApp(int argc, const char* argv[]);
+
+
+    namespace detail
+    {
+        char* HandleSuiteLibraryRequest(const char* request);
+        void FreeSuiteLibraryString(char* str);
+    }
+
 }
 
+
+#if defined(_WIN32)
+#   define BENCHMARKS_DETAIL_EXPORT __declspec(dllexport)
+#else
+#   define BENCHMARKS_DETAIL_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Exports the benchmarks registered with BENCHMARKS_REGISTER_CLASS from a shared library, so that two builds can be loaded
+// into one process with the interleave subtask
+#define BENCHMARKS_SUITE_LIBRARY() \
+    extern "C" BENCHMARKS_DETAIL_EXPORT char* benchmarks_suite_request(const char* request) \
+    { return ::benchmarks::detail::HandleSuiteLibraryRequest(request); } \
+    extern "C" BENCHMARKS_DETAIL_EXPORT void benchmarks_suite_free(char* str) \
+    { ::benchmarks::detail::FreeSuiteLibraryString(str); }
+
 #endif
@@ -1,5 +1,15 @@
 #include <benchmarks/BenchmarkContext.hpp>
 
+#include <benchmarks/utils/Barrier.hpp>
+#include <benchmarks/utils/ExecutionEnvironment.hpp>
+#include <benchmarks/utils/Profiler.hpp>
+#include <benchmarks/utils/SpinBarrier.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
 
 namespace benchmarks
 {
@@ -10,4 +20,105 @@ namespace benchmarks
             func();
     }
 
+
+    std::vector<std::chrono::nanoseconds> BenchmarkContext::RunConcurrently(int numThreads, const std::function<void(int)>& func) const
+    {
+        using namespace std::chrono;
+
+        if (numThreads <= 0)
+            throw std::invalid_argument("Invalid number of threads: " + std::to_string(numThreads));
+
+        std::vector<nanoseconds> durations(numThreads);
+        std::vector<std::exception_ptr> exceptions(numThreads);
+        SpinBarrier barrier(numThreads + 1);
+
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        for (int i = 0; i < numThreads; ++i)
+            threads.emplace_back([&, i]()
+                {
+                    ExecutionEnvironment::PinWorkerThread(i);
+                    barrier.Wait();
+                    try
+                    {
+                        BENCHMARKS_BARRIER;
+                        Profiler prof;
+                        BENCHMARKS_BARRIER;
+                        func(i);
+                        BENCHMARKS_BARRIER;
+                        durations[i] = duration_cast<nanoseconds>(prof.Reset());
+                        BENCHMARKS_BARRIER;
+                    }
+                    catch (...)
+                    { exceptions[i] = std::current_exception(); }
+                });
+
+        barrier.Wait();
+        for (auto& t : threads)
+            t.join();
+
+        for (auto&& ex : exceptions)
+            if (ex)
+                std::rethrow_exception(ex);
+
+        return durations;
+    }
+
+
+    void BenchmarkContext::DoProfileScaling(const std::string& name, int64_t count, bool totalCount, const std::vector<int>& threadCounts, const std::function<void(int, int)>& func)
+    {
+        double base_throughput_per_thread = 0;
+        for (int num_threads : threadCounts)
+        {
+            auto scaled_name = name + "_t" + std::to_string(num_threads);
+            auto durations = RunConcurrently(num_threads, [&](int threadIndex) { func(threadIndex, num_threads); });
+            double count_per_thread = totalCount ? (double)count / num_threads : (double)count;
+            ReportConcurrentDurations(scaled_name, count_per_thread, durations);
+
+            auto slowest = *std::max_element(durations.begin(), durations.end());
+            if (slowest.count() == 0)
+                continue;
+
+            double throughput_per_thread = count_per_thread / std::chrono::duration<double>(slowest).count();
+            if (base_throughput_per_thread == 0)
+                base_throughput_per_thread = throughput_per_thread;
+            ReportMetric(scaled_name + "_efficiency", throughput_per_thread / base_throughput_per_thread);
+        }
+    }
+
+
+    void BenchmarkContext::DoProfileAsync(const std::string& name, int64_t count, EventLoop* loop, const std::function<void(AsyncOperations&)>& func)
+    {
+        const int max_idle_spins = 4096;
+
+        AsyncOperations operations(MaxTrackableLatencyNs);
+        std::chrono::nanoseconds submission_duration;
+        {
+            IOperationProfilerPtr op(ProfileScope(name, count, ScopeKind::Opaque));
+            Profiler prof;
+            func(operations);
+            submission_duration = prof.Reset();
+
+            if (loop)
+                loop->RunUntil([&] { return operations.IsIdle(); });
+            else
+            {
+                for (int i = 0; !operations.IsIdle(); ++i)
+                {
+                    if (i < max_idle_spins)
+                        CpuRelax();
+                    else
+                        std::this_thread::yield();
+                }
+            }
+        }
+
+        if (operations.GetStartedCount() != count)
+            throw std::runtime_error(name + ": " + std::to_string(operations.GetStartedCount()) + " operations started, " + std::to_string(count) + " expected!");
+
+        if (submission_duration.count() > 0)
+            ReportMetric(name + "_submission_throughput", count * 1e9 / submission_duration.count());
+        ReportLatencies(name, operations.GetLatencies());
+    }
+
 }
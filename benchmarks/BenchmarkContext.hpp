@@ -11,8 +11,18 @@
 // WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 
+#include <benchmarks/utils/AsyncOperations.hpp>
+#include <benchmarks/utils/CacheEvictor.hpp>
+#include <benchmarks/utils/EventLoop.hpp>
+#include <benchmarks/utils/HdrHistogram.hpp>
+#include <benchmarks/utils/MemoryProbe.hpp>
+#include <benchmarks/utils/TscClock.hpp>
+
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 
 namespace benchmarks
@@ -21,12 +31,26 @@ namespace benchmarks
     struct IOperationProfiler
     {
         virtual ~IOperationProfiler() { }
+
+        // Runs the functor inside the scope, but leaves its time and counters out of the scope's results
+        virtual void Exclude(const std::function<void()>& func) { func(); }
     };
     using IOperationProfilerPtr = std::shared_ptr<IOperationProfiler>;
 
 
     class BenchmarkContext
     {
+    public:
+        static const int64_t MaxTrackableLatencyNs = 60LL * 1000 * 1000 * 1000;
+
+        // What a profiled scope consists of, the overhead subtraction depends on it
+        enum class ScopeKind
+        {
+            Loop,           // A loop over the operations
+            EachOperation,  // The operations are timed one by one
+            Opaque          // Anything else, only the overhead of the scope itself is known
+        };
+
     private:
         const int64_t       _iterationsCount;
 
@@ -40,8 +64,11 @@ namespace benchmarks
         int64_t GetIterationsCount() const
         { return _iterationsCount; }
 
-        virtual void MeasureMemory(const std::string& name, int64_t count) = 0;
-        virtual IOperationProfilerPtr Profile(const std::string& name, int64_t count) = 0;
+        virtual void MeasureMemory(const std::string& name, int64_t count, MemorySource source = MemorySource::Default) = 0;
+        IOperationProfilerPtr Profile(const std::string& name, int64_t count)
+        { return ProfileScope(name, count, ScopeKind::Loop); }
+
+        virtual IOperationProfilerPtr MeasurePeakMemory(const std::string& name, int64_t count) = 0;
 
         template < typename FunctorType_ >
         void Profile(const std::string& name, int64_t count, const FunctorType_& func)
@@ -50,6 +77,60 @@ namespace benchmarks
             func();
         }
 
+        // The caches are brought to the evictor's state once, before the scope starts
+        template < typename FunctorType_ >
+        void Profile(const std::string& name, int64_t count, const CacheEvictor& evictor, const FunctorType_& func)
+        {
+            evictor.Evict();
+            IOperationProfilerPtr op(Profile(name, count));
+            func();
+        }
+
+        // The mean time and the counters of the scope include the per-operation clock reads, unless the overhead is
+        // subtracted (--subtract-overhead)
+        template < typename FunctorType_ >
+        void ProfileEach(const std::string& name, int64_t count, const FunctorType_& func)
+        {
+            HdrHistogram latencies(MaxTrackableLatencyNs);
+            {
+                IOperationProfilerPtr op(ProfileScope(name, count, ScopeKind::EachOperation));
+                for (int64_t i = 0; i < count; ++i)
+                {
+                    auto start = TscClock::now();
+                    func(i);
+                    latencies.Record((TscClock::now() - start).count());
+                }
+            }
+            ReportLatencies(name, latencies);
+        }
+
+        // Brings the caches to the evictor's state before each operation. The eviction is excluded from the results of
+        // the scope, its time is reported as <name>_excluded_ns.
+        template < typename FunctorType_ >
+        void ProfileEach(const std::string& name, int64_t count, const CacheEvictor& evictor, const FunctorType_& func)
+        {
+            HdrHistogram latencies(MaxTrackableLatencyNs);
+            {
+                IOperationProfilerPtr op(ProfileScope(name, count, ScopeKind::EachOperation));
+                for (int64_t i = 0; i < count; ++i)
+                {
+                    if (evictor.GetState() != CacheState::Warm)
+                        op->Exclude([&] { evictor.Evict(); });
+                    auto start = TscClock::now();
+                    func(i);
+                    latencies.Record((TscClock::now() - start).count());
+                }
+            }
+            ReportLatencies(name, latencies);
+        }
+
+        template < typename FunctorType_ >
+        void MeasurePeakMemory(const std::string& name, int64_t count, const FunctorType_& func)
+        {
+            IOperationProfilerPtr op(MeasurePeakMemory(name, count));
+            func();
+        }
+
         template < typename FunctorType_ >
         void WarmUpAndProfile(const std::string& name, int64_t count, const FunctorType_& func, size_t numWarmUpPasses = 1)
         {
@@ -58,8 +139,68 @@ namespace benchmarks
             func();
         }
 
+        // The warm-up passes prepare the code and the allocators, the caches are brought to the evictor's state after them
+        template < typename FunctorType_ >
+        void WarmUpAndProfile(const std::string& name, int64_t count, const CacheEvictor& evictor, const FunctorType_& func, size_t numWarmUpPasses = 1)
+        {
+            DoWarmUp(func, numWarmUpPasses);
+            Profile(name, count, evictor, func);
+        }
+
+        // The count is the number of operations done by each thread
+        template < typename FunctorType_ >
+        void ProfileConcurrent(const std::string& name, int64_t count, int numThreads, const FunctorType_& func)
+        { ReportConcurrentDurations(name, (double)count, RunConcurrently(numThreads, func)); }
+
+        // The count is the number of operations done by all the threads together, e.g. the items passed through a queue
+        template < typename FunctorType_ >
+        void ProfileConcurrentTotal(const std::string& name, int64_t totalCount, int numThreads, const FunctorType_& func)
+        { ReportConcurrentDurations(name, (double)totalCount / numThreads, RunConcurrently(numThreads, func)); }
+
+        // The caches are brought to the evictor's state before the threads are started, the eviction of the caches of
+        // other cores is limited to the flushed ranges
+        template < typename FunctorType_ >
+        void ProfileConcurrent(const std::string& name, int64_t count, int numThreads, const CacheEvictor& evictor, const FunctorType_& func)
+        {
+            evictor.Evict();
+            ProfileConcurrent(name, count, numThreads, func);
+        }
+
+        // The functor submits the operations, marking them with AsyncOperations::Start and Complete. The scope ends
+        // when all the started operations are completed, the event loop (if any) is run until then.
+        template < typename FunctorType_ >
+        void ProfileAsync(const std::string& name, int64_t count, const FunctorType_& func)
+        { DoProfileAsync(name, count, nullptr, func); }
+
+        template < typename FunctorType_ >
+        void ProfileAsync(const std::string& name, int64_t count, EventLoop& loop, const FunctorType_& func)
+        { DoProfileAsync(name, count, &loop, func); }
+
+        template < typename FunctorType_ >
+        auto ProfileScaling(const std::string& name, int64_t count, const std::vector<int>& threadCounts, const FunctorType_& func) -> decltype(func(0), void())
+        { DoProfileScaling(name, count, false, threadCounts, [&](int threadIndex, int) { func(threadIndex); }); }
+
+        // The functor also gets the number of threads of the current run, e.g. to split them into producers and consumers
+        template < typename FunctorType_ >
+        auto ProfileScaling(const std::string& name, int64_t count, const std::vector<int>& threadCounts, const FunctorType_& func) -> decltype(func(0, 0), void())
+        { DoProfileScaling(name, count, false, threadCounts, func); }
+
+        // Same as ProfileScaling, but the total count is split between the threads of every run
+        template < typename FunctorType_ >
+        auto ProfileScalingTotal(const std::string& name, int64_t totalCount, const std::vector<int>& threadCounts, const FunctorType_& func) -> decltype(func(0, 0), void())
+        { DoProfileScaling(name, totalCount, true, threadCounts, func); }
+
+    protected:
+        virtual IOperationProfilerPtr ProfileScope(const std::string& name, int64_t count, ScopeKind kind) = 0;
+        virtual void ReportConcurrentDurations(const std::string& name, double countPerThread, const std::vector<std::chrono::nanoseconds>& durations) = 0;
+        virtual void ReportMetric(const std::string& name, double value) = 0;
+        virtual void ReportLatencies(const std::string& name, const HdrHistogram& latencies) = 0;
+
     private:
         void DoWarmUp(const std::function<void()>& func, size_t numWarmUpPasses) const;
+        std::vector<std::chrono::nanoseconds> RunConcurrently(int numThreads, const std::function<void(int)>& func) const;
+        void DoProfileScaling(const std::string& name, int64_t count, bool totalCount, const std::vector<int>& threadCounts, const std::function<void(int, int)>& func);
+        void DoProfileAsync(const std::string& name, int64_t count, EventLoop* loop, const std::function<void(AsyncOperations&)>& func);
     };
 
 }
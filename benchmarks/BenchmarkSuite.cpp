@@ -11,12 +11,23 @@
 #include <benchmarks/BenchmarkSuite.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <thread>
 
+#include <benchmarks/utils/AllocationCounters.hpp>
 #include <benchmarks/utils/Barrier.hpp>
+#include <benchmarks/utils/DoNotOptimize.hpp>
 #include <benchmarks/utils/Memory.hpp>
+#include <benchmarks/utils/MemoryProbe.hpp>
+#include <benchmarks/utils/PerfCounters.hpp>
 #include <benchmarks/utils/Profiler.hpp>
+#include <benchmarks/utils/RssSampler.hpp>
+#include <benchmarks/utils/SystemMonitor.hpp>
 
 
 namespace benchmarks
@@ -24,7 +35,7 @@ namespace benchmarks
 
     using namespace std::chrono;
 
-    class BenchmarkSuite::PreMeasureBenchmarkContext : public BenchmarkContext
+    class BenchmarkSuite::MeasureBenchmarkContext : public BenchmarkContext
     {
     public:
         using DurationsMap = std::map<std::string, nanoseconds>;
@@ -33,187 +44,712 @@ namespace benchmarks
         class OperationProfiler : public IOperationProfiler
         {
         private:
-            PreMeasureBenchmarkContext*     _inst;
+            MeasureBenchmarkContext*        _inst;
             std::string                     _name;
+            int64_t                         _count;
+            ScopeKind                       _kind;
+            PerfCounters::Snapshot          _countersStart;
+            bool                            _countersStarted;
+            AllocationCounters::Snapshot    _allocationsStart;
+            bool                            _allocationsStarted;
+            int                             _frequencyCpu;
+            int64_t                         _frequencyStartKhz;
+            TscClock::duration              _excludedDuration;
+            std::vector<double>             _excludedCounters;
+            AllocationCounters::Snapshot    _excludedAllocations;
             Profiler                        _prof;
 
         public:
-            OperationProfiler(PreMeasureBenchmarkContext* inst, const std::string& name)
-                : _inst(inst), _name(name)
+            OperationProfiler(MeasureBenchmarkContext* inst, const std::string& name, int64_t count, ScopeKind kind)
+                : _inst(inst), _name(name), _count(count), _kind(kind), _countersStarted(false), _excludedDuration(0), _excludedAllocations()
             {
+                // The frequency is read outside of the counters' windows, it is a syscall
+                _frequencyCpu = _inst->_frequencyProbe ? SystemMonitor::GetCurrentCpu() : -1;
+                _frequencyStartKhz = _inst->_frequencyProbe ? _inst->_frequencyProbe->ReadKhz(_frequencyCpu) : 0;
+                if (_inst->_perfCounters)
+                    _countersStarted = _inst->_perfCounters->Read(_countersStart);
+                _allocationsStarted = AllocationCounters::Read(_allocationsStart);
                 BENCHMARKS_BARRIER;
                 _prof.Reset();
                 BENCHMARKS_BARRIER;
             }
 
-            ~OperationProfiler()
+            virtual void Exclude(const std::function<void()>& func)
             {
+                PerfCounters::Snapshot counters_start, counters_end;
+                AllocationCounters::Snapshot allocations_start, allocations_end;
                 BENCHMARKS_BARRIER;
-                auto d = _prof.Reset();
+                auto start = TscClock::now();
+                bool counters_read = _countersStarted && _inst->_perfCounters->Read(counters_start);
+                bool allocations_read = _allocationsStarted && AllocationCounters::Read(allocations_start);
+                BENCHMARKS_BARRIER;
+                func();
+                BENCHMARKS_BARRIER;
+                counters_read = counters_read && _inst->_perfCounters->Read(counters_end);
+                allocations_read = allocations_read && AllocationCounters::Read(allocations_end);
+                _excludedDuration += TscClock::now() - start;
                 BENCHMARKS_BARRIER;
-                _inst->_durations.insert({_name, duration_cast<nanoseconds>(d)});
-            }
-        };
-
-    private:
-        DurationsMap        _durations;
-        int64_t             _maxRss;
-
-    public:
-        PreMeasureBenchmarkContext(int64_t iterationsCount)
-            : BenchmarkContext(iterationsCount), _maxRss(0)
-        { }
-
-        const DurationsMap& GetDurationsMap() const { return _durations; }
-        int64_t GetMaxRss() const { return _maxRss; }
-
-        virtual void MeasureMemory(const std::string& name, int64_t count)
-        {
-            BENCHMARKS_BARRIER;
-            auto rss = Memory::GetRss();
-            BENCHMARKS_BARRIER;
-            _maxRss = std::max(rss, _maxRss);
-        }
-
-        virtual IOperationProfilerPtr Profile(const std::string& name, int64_t count)
-        { return std::make_shared<OperationProfiler>(this, name); }
-    };
 
+                if (counters_read)
+                {
+                    _excludedCounters.resize(_inst->_perfCounters->GetNames().size());
+                    for (size_t i = 0; i < _excludedCounters.size(); ++i)
+                    {
+                        double delta = 0;
+                        if (PerfCounters::GetDelta(counters_start, counters_end, i, delta))
+                            _excludedCounters[i] += delta;
+                    }
+                }
+                if (allocations_read)
+                {
+                    _excludedAllocations.allocs += allocations_end.allocs - allocations_start.allocs;
+                    _excludedAllocations.frees += allocations_end.frees - allocations_start.frees;
+                    _excludedAllocations.bytes += allocations_end.bytes - allocations_start.bytes;
+                }
+            }
 
-    ////////////////////////////////////////////////////////////////////////////////
+            ~OperationProfiler()
+            {
+                BENCHMARKS_BARRIER;
+                auto total = _prof.Reset();
+                BENCHMARKS_BARRIER;
+                PerfCounters::Snapshot counters_end;
+                bool counters_read = _countersStarted && _inst->_perfCounters->Read(counters_end);
+                AllocationCounters::Snapshot allocations_end;
+                bool allocations_read = _allocationsStarted && AllocationCounters::Read(allocations_end);
+                // Frequencies of different cores are not comparable, so the drift is not checked after a migration
+                if (_frequencyStartKhz > 0 && SystemMonitor::GetCurrentCpu() == _frequencyCpu)
+                    _inst->CheckFrequencyDrift(_name, _frequencyStartKhz, _inst->_frequencyProbe->ReadKhz(_frequencyCpu));
+
+                // The calibration has to see the excluded time, e.g. the cache eviction takes most of a cold benchmark
+                _inst->AddDuration(_name, duration_cast<nanoseconds>(total));
+                auto d = total - std::min(total, _excludedDuration);
+                auto ns = duration_cast<duration<double, std::nano>>(d).count();
+                _inst->_resultsReporter->ReportOperationDuration(_name, _inst->_subtractOverhead ? SubtractOverhead(ns) : ns / _count);
+                if (_excludedDuration.count() > 0)
+                    _inst->_resultsReporter->ReportMetric(_name + "_excluded_ns", duration_cast<duration<double, std::nano>>(_excludedDuration).count() / _count);
+
+                if (allocations_read)
+                {
+                    _inst->_resultsReporter->ReportCounter(_name, "allocs", double(allocations_end.allocs - _allocationsStart.allocs - _excludedAllocations.allocs) / _count);
+                    _inst->_resultsReporter->ReportCounter(_name, "frees", double(allocations_end.frees - _allocationsStart.frees - _excludedAllocations.frees) / _count);
+                    _inst->_resultsReporter->ReportCounter(_name, "alloc_bytes", double(allocations_end.bytes - _allocationsStart.bytes - _excludedAllocations.bytes) / _count);
+                }
+
+                if (!counters_read)
+                    return;
+
+                const double min_instructions_per_operation = 1;
+                const auto& counter_names = _inst->_perfCounters->GetNames();
+                for (size_t i = 0; i < counter_names.size(); ++i)
+                {
+                    double delta = 0;
+                    if (!PerfCounters::GetDelta(_countersStart, counters_end, i, delta))
+                        continue;
+                    if (i < _excludedCounters.size())
+                        delta = std::max(0.0, delta - _excludedCounters[i]);
+
+                    _inst->_resultsReporter->ReportCounter(_name, counter_names[i], delta / _count);
+                    if (counter_names[i] == "instructions" && delta / _count < min_instructions_per_operation)
+                        _inst->_resultsReporter->ReportWarning(_name, "only " + std::to_string(delta / _count) + " instructions per operation, the measured code is probably optimized away");
+                }
+            }
 
+        private:
+            double SubtractOverhead(double ns) const
+            {
+                const MeasurementOverhead& o = _inst->_overhead;
+                switch (_kind)
+                {
+                case ScopeKind::Loop:           return o.Subtract(ns, _count, o.iterationNs);
+                case ScopeKind::EachOperation:  return o.Subtract(ns, _count, o.eachOperationNs);
+                default:                        return o.Subtract(ns, _count, 0);
+                }
+            }
+        };
 
-    class BenchmarkSuite::MeasureBenchmarkContext : public BenchmarkContext
-    {
-        class OperationProfiler : public IOperationProfiler
+        class PeakMemoryProfiler : public IOperationProfiler
         {
         private:
             MeasureBenchmarkContext*        _inst;
             std::string                     _name;
             int64_t                         _count;
-            Profiler                        _prof;
+            std::unique_ptr<RssSampler>     _sampler;
 
         public:
-            OperationProfiler(MeasureBenchmarkContext* inst, const std::string& name, int64_t count)
+            PeakMemoryProfiler(MeasureBenchmarkContext* inst, const std::string& name, int64_t count)
                 : _inst(inst), _name(name), _count(count)
             {
-                BENCHMARKS_BARRIER;
-                _prof.Reset();
+                if (!Memory::ResetPeakRss())
+                    s_logger.Debug() << "Could not reset the peak RSS, " << _name << " may report a stale peak";
+                if (_inst->_memoryTimelineInterval.count() > 0)
+                    _sampler.reset(new RssSampler(_inst->_memoryTimelineInterval));
                 BENCHMARKS_BARRIER;
             }
 
-            ~OperationProfiler()
+            ~PeakMemoryProfiler()
             {
                 BENCHMARKS_BARRIER;
-                auto d = _prof.Reset();
+                auto peak = Memory::GetPeakRss();
                 BENCHMARKS_BARRIER;
-                auto ns = duration_cast<duration<double, std::nano>>(d).count();
-                _inst->_resultsReporter->ReportOperationDuration(_name, ns / _count);
+
+                MemoryTimeline timeline;
+                if (_sampler)
+                    timeline = _sampler->Stop();
+                for (auto&& p : timeline)
+                    peak = std::max(peak, p.bytes);
+
+                _inst->_maxRss = std::max(peak, _inst->_maxRss);
+                _inst->_resultsReporter->ReportMemoryConsumption(_name, (peak - _inst->_memoryBaselines[MemorySource::Rss]) / _count);
+                if (_sampler)
+                    _inst->_resultsReporter->ReportMemoryTimeline(_name, timeline);
             }
         };
 
     private:
         IBenchmarksResultsReporterPtr       _resultsReporter;
-        int64_t                             _baselineRss;
+        std::unique_ptr<PerfCounters>       _perfCounters;
+        std::unique_ptr<CpuFrequencyProbe>  _frequencyProbe;
+        NoisePolicy                         _noisePolicy;
+        double                              _maxFrequencyDrift;
+        std::string                         _noiseError;
+        MemorySource                        _defaultMemorySource;
+        microseconds                        _memoryTimelineInterval;
+        MemoryProbe                         _memoryProbe;
+        std::map<MemorySource, int64_t>     _memoryBaselines;
+        DurationsMap                        _durations;
+        int64_t                             _maxRss;
+        bool                                _subtractOverhead;
+        MeasurementOverhead                 _overhead;
 
     public:
-        MeasureBenchmarkContext(int64_t iterationsCount, IBenchmarksResultsReporterPtr resultsReporter)
-            : BenchmarkContext(iterationsCount), _resultsReporter(std::move(resultsReporter))
-        { _baselineRss = Memory::GetRss(); }
+        MeasureBenchmarkContext(int64_t iterationsCount, IBenchmarksResultsReporterPtr resultsReporter, const MeasurementOptions& options)
+            : BenchmarkContext(iterationsCount), _resultsReporter(std::move(resultsReporter)),
+              _noisePolicy(options.noisePolicy), _maxFrequencyDrift(options.maxFrequencyDrift), _defaultMemorySource(options.memorySource), _memoryTimelineInterval(options.memoryTimelineInterval), _maxRss(0),
+              _subtractOverhead(false)
+        {
+            if (options.perfCounters)
+            {
+                _perfCounters.reset(new PerfCounters);
+                if (!_perfCounters->IsAvailable())
+                    _perfCounters.reset();
+            }
+            if (_noisePolicy != NoisePolicy::Ignore)
+            {
+                _frequencyProbe.reset(new CpuFrequencyProbe);
+                if (!_frequencyProbe->IsAvailable())
+                    _frequencyProbe.reset();
+            }
+            // The smaps_rollup based sources are expensive to read, so only the ones that may be used get a baseline
+            ReadMemoryBaseline(MemorySource::Rss);
+            if (_defaultMemorySource != MemorySource::Rss)
+                ReadMemoryBaseline(_defaultMemorySource);
+        }
+
+        const DurationsMap& GetDurationsMap() const { return _durations; }
+
+        void SubtractOverhead(const MeasurementOverhead& overhead)
+        {
+            _subtractOverhead = true;
+            _overhead = overhead;
+        }
+        int64_t GetMaxRss() const { return _maxRss; }
 
-        virtual void MeasureMemory(const std::string& name, int64_t count)
+        void CheckNoise() const
         {
+            if (!_noiseError.empty())
+                throw std::runtime_error(_noiseError);
+        }
+
+        virtual void MeasureMemory(const std::string& name, int64_t count, MemorySource source)
+        {
+            if (source == MemorySource::Default)
+                source = _defaultMemorySource;
+            if (!_memoryProbe.IsAvailable(source))
+                throw std::runtime_error("Memory source " + MemorySourceToString(source) + " is not available!");
+
+            auto baseline = _memoryBaselines.find(source);
+            if (baseline == _memoryBaselines.end())
+                throw std::runtime_error("No baseline for memory source " + MemorySourceToString(source) + ", select it with --memory-source!");
+
             BENCHMARKS_BARRIER;
-            auto rss = Memory::GetRss() - _baselineRss;
+            auto value = _memoryProbe.Read(source);
             BENCHMARKS_BARRIER;
-            _resultsReporter->ReportMemoryConsumption(name, rss / count);
+            _maxRss = std::max(source == MemorySource::Rss ? value : Memory::GetRss(), _maxRss);
+            _resultsReporter->ReportMemoryConsumption(name, (value - baseline->second) / count);
+        }
+
+
+        virtual IOperationProfilerPtr MeasurePeakMemory(const std::string& name, int64_t count)
+        { return std::make_shared<PeakMemoryProfiler>(this, name, count); }
+
+    protected:
+        virtual IOperationProfilerPtr ProfileScope(const std::string& name, int64_t count, ScopeKind kind)
+        { return std::make_shared<OperationProfiler>(this, name, count, kind); }
+
+        virtual void ReportConcurrentDurations(const std::string& name, double countPerThread, const std::vector<nanoseconds>& durations)
+        {
+            auto minmax = std::minmax_element(durations.begin(), durations.end());
+            auto fastest_ns = duration_cast<duration<double, std::nano>>(*minmax.first).count();
+            auto slowest_ns = duration_cast<duration<double, std::nano>>(*minmax.second).count();
+
+            AddDuration(name, *minmax.second);
+            _resultsReporter->ReportOperationDuration(name, slowest_ns / countPerThread);
+            _resultsReporter->ReportOperationDuration(name + "_fastest", fastest_ns / countPerThread);
+            if (slowest_ns > 0)
+                _resultsReporter->ReportMetric(name + "_throughput", durations.size() * countPerThread * 1e9 / slowest_ns);
+        }
+
+        virtual void ReportMetric(const std::string& name, double value)
+        { _resultsReporter->ReportMetric(name, value); }
+
+        virtual void ReportLatencies(const std::string& name, const HdrHistogram& latencies)
+        { _resultsReporter->ReportLatencies(name, latencies); }
+
+    private:
+        void ReadMemoryBaseline(MemorySource source)
+        {
+            if (!_memoryProbe.IsAvailable(source))
+                return;
+            try
+            { _memoryBaselines[source] = _memoryProbe.Read(source); }
+            catch (const std::exception& ex)
+            { s_logger.Debug() << "Could not read the " << MemorySourceToString(source) << " memory baseline: " << ex.what(); }
+        }
+
+        void CheckFrequencyDrift(const std::string& name, int64_t startKhz, int64_t endKhz)
+        {
+            if (endKhz <= 0 || std::abs(endKhz - startKhz) <= _maxFrequencyDrift * startKhz)
+                return;
+
+            std::string message = "CPU frequency drifted from " + std::to_string(startKhz / 1000) + " to " + std::to_string(endKhz / 1000) + " MHz during " + name;
+            s_logger.Warning() << message;
+            if (_noisePolicy == NoisePolicy::Abort && _noiseError.empty())
+                _noiseError = message;
+        }
+
+        void AddDuration(const std::string& name, nanoseconds d)
+        {
+            auto& total = _durations[name];
+            total = std::max(total, d);
+        }
+    };
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+
+    class BenchmarkSuite::SamplesCollector : public IBenchmarksResultsReporter
+    {
+        using SamplesMap = std::map<std::string, std::vector<double>>;
+
+    private:
+        SamplesMap                                  _durations;
+        SamplesMap                                  _memory;
+        SamplesMap                                  _metrics;
+        std::map<std::string, SamplesMap>           _counters;
+        std::map<std::string, MemoryTimeline>       _memoryTimelines;
+        std::map<std::string, HdrHistogram>         _latencies;
+        std::map<std::string, std::set<std::string>> _warnings;
+
+    public:
+        virtual void ReportOperationDuration(const std::string& name, double ns)
+        { _durations[name].push_back(ns); }
+
+        virtual void ReportMemoryConsumption(const std::string& name, int64_t bytes)
+        { _memory[name].push_back((double)bytes); }
+
+        virtual void ReportMetric(const std::string& name, double value)
+        { _metrics[name].push_back(value); }
+
+        virtual void ReportCounter(const std::string& name, const std::string& counter, double valuePerOperation)
+        { _counters[name][counter].push_back(valuePerOperation); }
+
+        virtual void ReportOperationStatistics(const std::string& name, const SampleStatistics& statistics)
+        { _durations[name].insert(_durations[name].end(), statistics.GetSamples().begin(), statistics.GetSamples().end()); }
+
+        virtual void ReportMemoryTimeline(const std::string& name, const MemoryTimeline& timeline)
+        { _memoryTimelines[name] = timeline; }
+
+        virtual void ReportLatencies(const std::string& name, const HdrHistogram& latencies)
+        {
+            auto it = _latencies.find(name);
+            if (it == _latencies.end())
+                _latencies.insert({name, latencies});
+            else
+                it->second.Add(latencies);
         }
 
-        virtual IOperationProfilerPtr Profile(const std::string& name, int64_t count)
-        { return std::make_shared<OperationProfiler>(this, name, count); }
+        virtual void ReportWarning(const std::string& name, const std::string& message)
+        { _warnings[name].insert(message); }
+
+        double GetMedianDuration(const std::string& name) const
+        {
+            auto it = _durations.find(name);
+            return it == _durations.end() ? 0 : Median(it->second);
+        }
+
+        void ReportTo(IBenchmarksResultsReporter& reporter, const MeasurementOptions& options) const
+        {
+            for (auto p : _durations)
+            {
+                auto statistics = SampleStatistics::Compute(p.second, options.outlierRule, options.confidence, options.bootstrapResamples);
+                reporter.ReportOperationDuration(p.first, statistics.GetMedian());
+                reporter.ReportOperationStatistics(p.first, statistics);
+            }
+
+            for (auto p : _memory)
+                reporter.ReportMemoryConsumption(p.first, (int64_t)Median(p.second));
+
+            for (auto p : _metrics)
+                reporter.ReportMetric(p.first, Median(p.second));
+
+            for (auto p : _counters)
+                for (auto c : p.second)
+                    reporter.ReportCounter(p.first, c.first, Median(c.second));
+
+            for (auto&& p : _memoryTimelines)
+                reporter.ReportMemoryTimeline(p.first, p.second);
+
+            for (auto&& p : _latencies)
+                reporter.ReportLatencies(p.first, p.second);
+
+            for (auto&& p : _warnings)
+                for (auto&& message : p.second)
+                    reporter.ReportWarning(p.first, message);
+        }
     };
 
 
     ////////////////////////////////////////////////////////////////////////////////
 
 
+    namespace detail
+    {
+        BenchmarksClassDescriptors& GetStaticBenchmarksClasses()
+        {
+            static BenchmarksClassDescriptors classes;
+            return classes;
+        }
+    }
+
+
     BENCHMARKS_LOGGER(BenchmarkSuite);
 
-    int64_t BenchmarkSuite::MeasureIterationsCount(const ParameterizedBenchmarkId& id) const
+    void BenchmarkSuite::RegisterStaticBenchmarks()
     {
-        const int multiplier = 2;
+        const auto& classes = detail::GetStaticBenchmarksClasses();
+        std::lock_guard<std::mutex> l(_classesMutex);
+        _classes.insert(_classes.end(), classes.begin(), classes.end());
+    }
 
-        auto it = _benchmarks.find(id.GetId());
+
+    std::vector<BenchmarkId> BenchmarkSuite::GetBenchmarkIds(const ClassFilter& filter) const
+    {
+        std::lock_guard<std::mutex> l(_classesMutex);
+        for (auto&& c : _classes)
+        {
+            if (!filter || c.className.empty() || filter(c.className, c.objectName))
+                LoadClass(c);
+        }
+
+        std::vector<BenchmarkId> result;
+        for (auto p : _benchmarks)
+            if (!filter || filter(p.first.GetClassName(), p.first.GetObjectName()))
+                result.push_back(p.first);
+        return result;
+    }
+
+
+    void BenchmarkSuite::LoadClass(detail::BenchmarksClassDescriptor& c) const
+    {
+        if (c.loaded)
+            return;
+
+        s_logger.Debug() << "Loading " << (c.className.empty() ? "<unnamed>" : c.className) << " benchmarks for " << c.objectName;
+        auto class_name = c.load(_benchmarks);
+        if (!c.className.empty() && c.className != class_name)
+            throw std::runtime_error("Benchmarks class registered as " + c.className + " is named " + class_name + "!");
+        c.className = class_name;
+        c.loaded = true;
+    }
+
+
+    const IBenchmarkPtr& BenchmarkSuite::GetBenchmark(const BenchmarkId& id) const
+    {
+        std::lock_guard<std::mutex> l(_classesMutex);
+        for (auto&& c : _classes)
+        {
+            if (c.objectName == id.GetObjectName() && (c.className.empty() || c.className == id.GetClassName()))
+                LoadClass(c);
+        }
+
+        auto it = _benchmarks.find(id);
         if (it == _benchmarks.end())
-            throw std::runtime_error("Benchmark " + id.GetId().ToString() + " not found!");
+            throw std::runtime_error("Benchmark " + id.ToString() + " not found!");
+        return it->second;
+    }
+
 
+    int64_t BenchmarkSuite::Calibrate(const ParameterizedBenchmarkId& id, const MeasurementOptions& options, SamplesCollectorPtr& lastRound) const
+    {
+        const double margin = 1.2;
+        const double min_growth = 1.2;
+        const double max_growth = 1000;
+        const double min_duration_target_ns = 1e8;
+        const double max_duration_limit_ns = 1e10;
+        const int64_t rss_multiplier = 30;
+
+        const auto& benchmark = GetBenchmark(id.GetId());
+        ScalingPoints scaling_points;
+
+        AllocationPolicy::SetDefault(options.allocationPolicy);
+        Memory::ReleaseFreeMemory();
         int64_t total_mem = Memory::GetTotalPhys();
         int64_t baseline_rss = Memory::GetRss();
         int64_t num_iterations = 1;
         while (true)
         {
-            PreMeasureBenchmarkContext ctx(num_iterations);
-            it->second->Perform(ctx, id.GetParams());
-
-            using DurationsMapPair = PreMeasureBenchmarkContext::DurationsMap::value_type;
+            lastRound = std::make_shared<SamplesCollector>();
+            MeasureBenchmarkContext ctx(num_iterations, lastRound, options);
+            if (options.subtractOverhead)
+                ctx.SubtractOverhead(GetMeasurementOverhead(options));
+            benchmark->Perform(ctx, id.GetParams());
+            ctx.CheckNoise();
+
+            using DurationsMapPair = MeasureBenchmarkContext::DurationsMap::value_type;
             auto& dm = ctx.GetDurationsMap();
             auto minmax_element = std::minmax_element(dm.begin(), dm.end(), [](const DurationsMapPair& l, const DurationsMapPair& r) { return l.second < r.second; } );
-            auto min_duration = minmax_element.first == dm.end() ? nanoseconds() : minmax_element.first->second;
-            auto max_duration = minmax_element.second == dm.end() ? nanoseconds() : minmax_element.second->second;
+            double min_ns = minmax_element.first == dm.end() ? 0 : (double)minmax_element.first->second.count();
+            double max_ns = minmax_element.second == dm.end() ? 0 : (double)minmax_element.second->second.count();
             auto max_rss = ctx.GetMaxRss();
+            auto rss_growth = max_rss - baseline_rss;
 
-            s_logger.Debug() << "num_iterations: " << num_iterations << ", min_duration: " << min_duration.count() << " ns, max_duration: " << max_duration.count() << " ns, max_rss: " << max_rss << ", Memory::GetRss(): " << Memory::GetRss() / (1024 * 1024) << "MB";
+            for (auto&& p : dm)
+                scaling_points[p.first].push_back({(double)num_iterations, (double)p.second.count()});
 
-            auto next_min_duration = min_duration * multiplier;
-            auto next_max_rss = max_rss * multiplier;
+            s_logger.Debug() << "num_iterations: " << num_iterations << ", min_duration: " << min_ns << " ns, max_duration: " << max_ns << " ns, max_rss: " << max_rss << ", Memory::GetRss(): " << Memory::GetRss() / (1024 * 1024) << "MB";
 
             if (num_iterations * nanoseconds(1) > seconds(20))
                 throw std::runtime_error("Iteration time too small. Your benchmark is probably invalid or optimized away.");
 
-            if (max_duration > seconds(10))
+            if (max_ns > max_duration_limit_ns)
             {
                 s_logger.Warning() << "Max time limit exceeded!";
-                for (auto p : ctx.GetDurationsMap())
-                    s_logger.Warning() << "  " << p.first << ": " << p.second.count() << " ms";
+                for (auto p : dm)
+                    s_logger.Warning() << "  " << p.first << ": " << p.second.count() << " ns";
                 break;
             }
 
-            if (next_max_rss > total_mem * 1 / 2)
-            {
-                s_logger.Warning() << "Memory limit exceeded!";
-                s_logger.Warning() << "  total mem: " << total_mem;
-                s_logger.Warning() << "  max rss: " << max_rss;
-                s_logger.Warning() << "  next max rss: " << next_max_rss;
-                s_logger.Warning() << "durations:";
-                for (auto p : ctx.GetDurationsMap())
-                    s_logger.Warning() << "  " << p.first << ": " << p.second.count() << " ms";
+            bool duration_ok = dm.empty() || min_ns >= min_duration_target_ns;
+            bool memory_ok = max_rss == 0 || max_rss >= baseline_rss * rss_multiplier;
+            if (duration_ok && memory_ok)
                 break;
+
+            double growth = min_growth;
+            if (!duration_ok)
+                growth = std::max(growth, min_ns > 0 ? margin * min_duration_target_ns / min_ns : max_growth);
+            if (!memory_ok)
+                growth = std::max(growth, rss_growth > 0 ? margin * (baseline_rss * (rss_multiplier - 1)) / rss_growth : max_growth);
+            growth = std::min(growth, max_growth);
+
+            if (max_ns > 0 && max_ns * growth > max_duration_limit_ns / 2)
+            {
+                growth = max_duration_limit_ns / 2 / max_ns;
+                if (growth < min_growth)
+                {
+                    s_logger.Warning() << "Max time limit reached!";
+                    for (auto p : dm)
+                        s_logger.Warning() << "  " << p.first << ": " << p.second.count() << " ns";
+                    break;
+                }
             }
 
-            if ((dm.empty() || next_min_duration > milliseconds(100)) &&
-                (max_rss == 0 || next_max_rss > baseline_rss * 30))
+            if (rss_growth > 0 && baseline_rss + rss_growth * growth > total_mem / 2)
             {
-                num_iterations *= multiplier;
-                break;
+                growth = double(total_mem / 2 - baseline_rss) / rss_growth;
+                if (growth < min_growth)
+                {
+                    s_logger.Warning() << "Memory limit exceeded!";
+                    s_logger.Warning() << "  total mem: " << total_mem;
+                    s_logger.Warning() << "  max rss: " << max_rss;
+                    s_logger.Warning() << "durations:";
+                    for (auto p : dm)
+                        s_logger.Warning() << "  " << p.first << ": " << p.second.count() << " ns";
+                    break;
+                }
             }
 
-            num_iterations *= multiplier;
+            num_iterations = std::max(num_iterations + 1, (int64_t)(num_iterations * growth));
         }
 
+        CheckScaling(scaling_points, *lastRound);
+
+        std::lock_guard<std::mutex> l(_calibrationsMutex);
+        _calibrations[id.ToString()] = num_iterations;
         return num_iterations;
     }
 
 
-    void BenchmarkSuite::InvokeBenchmark(int64_t iterations, const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter) const
+    void BenchmarkSuite::CheckScaling(const ScalingPoints& points, IBenchmarksResultsReporter& reporter)
+    {
+        const double min_iterations_ratio = 8;
+        const double min_slope = 0.5;
+        const double min_scaling_duration_ns = 1e6;
+        const double min_iteration_ns = 0.01;
+        const double min_elided_iterations = 1e6;
+
+        for (auto&& p : points)
+        {
+            // Points come in the order of growing iterations, the last one is the most precise
+            if (p.second.empty())
+                continue;
+            const auto& last = p.second.back();
+            if (last.first >= min_elided_iterations && last.second < last.first * min_iteration_ns)
+            {
+                std::stringstream ss;
+                ss << "an iteration takes " << std::setprecision(2) << last.second / last.first << " ns, the measured loop is probably optimized away";
+                reporter.ReportWarning(p.first, ss.str());
+                continue;
+            }
+
+            // Shorter durations are dominated by the clock and the scope overhead
+            std::vector<std::pair<double, double>> v;
+            for (auto&& point : p.second)
+                if (point.second >= min_scaling_duration_ns)
+                    v.push_back(point);
+            if (v.size() < 2 || v.back().first < v.front().first * min_iterations_ratio)
+                continue;
+
+            // Least squares slope of log(duration) over log(iterations), a measured loop should have it close to 1
+            double mean_x = 0, mean_y = 0;
+            for (auto&& point : v)
+            {
+                mean_x += std::log(point.first) / v.size();
+                mean_y += std::log(point.second) / v.size();
+            }
+
+            double sxy = 0, sxx = 0;
+            for (auto&& point : v)
+            {
+                double dx = std::log(point.first) - mean_x;
+                sxy += dx * (std::log(point.second) - mean_y);
+                sxx += dx * dx;
+            }
+
+            double slope = sxy / sxx;
+            s_logger.Debug() << p.first << ": duration grows as iterations^" << slope;
+            if (slope < min_slope)
+            {
+                std::stringstream ss;
+                ss << "the duration does not scale with the iterations count (grows as iterations^" << std::setprecision(2) << slope << "), the measured loop is probably hoisted or optimized away";
+                reporter.ReportWarning(p.first, ss.str());
+            }
+        }
+    }
+
+
+    const MeasurementOverhead& BenchmarkSuite::GetMeasurementOverhead(const MeasurementOptions& options) const
+    {
+        auto key = std::make_pair(options.perfCounters, options.noisePolicy != NoisePolicy::Ignore);
+        // The lock is held during the measurement, so that concurrent callers neither measure twice nor disturb it
+        std::lock_guard<std::mutex> l(_overheadsMutex);
+        auto it = _overheads.find(key);
+        if (it == _overheads.end())
+            it = _overheads.insert({key, MeasureOverhead(options)}).first;
+        return it->second;
+    }
+
+
+    MeasurementOverhead BenchmarkSuite::MeasureOverhead(const MeasurementOptions& options) const
     {
+        const int num_rounds = 15;
+        const int64_t num_scopes = 1000;
+        const int64_t loop_iterations = 1000000;
+        const int64_t each_operations = 100000;
+
+        auto collector = std::make_shared<SamplesCollector>();
+        for (int i = 0; i < num_rounds; ++i)
+        {
+            MeasureBenchmarkContext ctx(loop_iterations, collector, options);
+            for (int64_t j = 0; j < num_scopes; ++j)
+                ctx.Profile("scope", 1, [] { });
+            // A const sink may stay in a register, the non-const DoNotOptimize would add a store and a load to every iteration
+            ctx.Profile("loop", loop_iterations, [] { for (int64_t j = 0; j < loop_iterations; ++j) DoNotOptimize(static_cast<const int64_t&>(j)); });
+            ctx.ProfileEach("each", each_operations, [] (const int64_t j) { DoNotOptimize(j); });
+        }
+
+        double scope_ns = collector->GetMedianDuration("scope");
+        double iteration_ns = std::max(0.0, collector->GetMedianDuration("loop") - scope_ns / loop_iterations);
+        double each_operation_ns = std::max(0.0, collector->GetMedianDuration("each") - scope_ns / each_operations);
+        s_logger.Verbose() << "Measurement overhead: " << scope_ns << " ns per scope, " << iteration_ns << " ns per loop iteration, " << each_operation_ns << " ns per ProfileEach operation";
+        return MeasurementOverhead(scope_ns, iteration_ns, each_operation_ns);
+    }
+
+
+    void BenchmarkSuite::CollectSamples(int64_t iterations, const ParameterizedBenchmarkId& id, const MeasurementOptions& options, int numSamples, const SamplesCollectorPtr& collector, ScalingPoints& scalingPoints) const
+    {
+        const auto& benchmark = GetBenchmark(id.GetId());
+        AllocationPolicy::SetDefault(options.allocationPolicy);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Memory::ReleaseFreeMemory();
+            MeasureBenchmarkContext ctx(iterations, collector, options);
+            if (options.subtractOverhead)
+                ctx.SubtractOverhead(GetMeasurementOverhead(options));
+            benchmark->Perform(ctx, id.GetParams());
+            ctx.CheckNoise();
+
+            for (auto&& p : ctx.GetDurationsMap())
+                scalingPoints[p.first].push_back({(double)iterations, (double)p.second.count()});
+        }
+    }
+
+
+    int64_t BenchmarkSuite::MeasureIterationsCount(const ParameterizedBenchmarkId& id, const MeasurementOptions& options) const
+    {
+        SamplesCollectorPtr last_round;
+        return Calibrate(id, options, last_round);
+    }
+
+
+    void BenchmarkSuite::InvokeBenchmark(int64_t iterations, const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter, const MeasurementOptions& options) const
+    {
+        const int64_t scaling_probe_divisor = 16;
+
         s_logger.Debug() << "iterations: " << iterations;
 
-        auto it = _benchmarks.find(id.GetId());
-        if (it == _benchmarks.end())
-            throw std::runtime_error("Benchmark " + id.GetId().ToString() + " not found!");
+        bool calibrated = false;
+        {
+            std::lock_guard<std::mutex> l(_calibrationsMutex);
+            auto it = _calibrations.find(id.ToString());
+            calibrated = it != _calibrations.end() && it->second == iterations;
+        }
+
+        // Calibrate has already checked the scaling for its own iterations count, the one from a cache or the caller
+        // needs a shorter run to check that the measured loop scales with it
+        ScalingPoints scaling_points;
+        if (!calibrated && iterations >= scaling_probe_divisor)
+            CollectSamples(iterations / scaling_probe_divisor, id, options, 1, std::make_shared<SamplesCollector>(), scaling_points);
+
+        auto collector = std::make_shared<SamplesCollector>();
+        CollectSamples(iterations, id, options, std::max(1, options.samples), collector, scaling_points);
+        if (!calibrated)
+            CheckScaling(scaling_points, *collector);
+        collector->ReportTo(*resultsReporter, options);
+    }
+
+
+    int64_t BenchmarkSuite::MeasureAndInvokeBenchmark(const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter, const MeasurementOptions& options) const
+    {
+        SamplesCollectorPtr collector;
+        auto iterations = Calibrate(id, options, collector);
+        s_logger.Debug() << "iterations: " << iterations;
 
-        MeasureBenchmarkContext ctx(iterations, resultsReporter);
-        it->second->Perform(ctx, id.GetParams());
+        ScalingPoints scaling_points;
+        CollectSamples(iterations, id, options, options.samples - 1, collector, scaling_points);
+        collector->ReportTo(*resultsReporter, options);
+        return iterations;
     }
 
 }
@@ -12,11 +12,19 @@
 
 
 #include <benchmarks/Benchmark.hpp>
+#include <benchmarks/detail/MeasurementOptions.hpp>
+#include <benchmarks/detail/MeasurementOverhead.hpp>
 #include <benchmarks/detail/ParameterizedBenchmarkId.hpp>
 #include <benchmarks/utils/Logger.hpp>
+#include <benchmarks/utils/HdrHistogram.hpp>
+#include <benchmarks/utils/RssSampler.hpp>
+#include <benchmarks/utils/Statistics.hpp>
 
+#include <functional>
 #include <map>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
 
 
 namespace benchmarks
@@ -27,34 +35,83 @@ namespace benchmarks
         using BenchmarksMap = std::map<BenchmarkId, IBenchmarkPtr>;
 
 
+        // Instantiates a benchmarks class only when one of its benchmarks is requested
+        struct BenchmarksClassDescriptor
+        {
+            using LoadFunc = std::function<std::string(BenchmarksMap&)>;
+
+            std::string     className; // empty if not known before loading
+            std::string     objectName;
+            LoadFunc        load;
+            bool            loaded;
+
+            BenchmarksClassDescriptor(std::string className, std::string objectName, LoadFunc load)
+                : className(std::move(className)), objectName(std::move(objectName)), load(std::move(load)), loaded(false)
+            { }
+        };
+        using BenchmarksClassDescriptors = std::vector<BenchmarksClassDescriptor>;
+
+
+        template < template <typename> class BenchmarksClass_, typename ObjectsDesc_ >
+        std::string LoadBenchmarksClass(BenchmarksMap& benchmarks)
+        {
+            BenchmarksClass_<ObjectsDesc_> bm;
+            for (auto b : bm.GetBenchmarks())
+                benchmarks.insert({BenchmarkId(bm.GetName(), b->GetName(), ObjectsDesc_::GetName()), b});
+            return bm.GetName();
+        }
+
+
         template < template <typename> class BenchmarksClass_, typename... ObjectsDesc_ >
         struct BenchmarksClassRegistrar
         {
-            static void Register(BenchmarksMap& benchmarks)
+            static void Register(BenchmarksClassDescriptors& classes, const std::string& className)
             { }
         };
 
         template < template <typename> class BenchmarksClass_, typename ObjectsDescHead_, typename... ObjectsDescTail_ >
         struct BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDescHead_, ObjectsDescTail_...>
         {
-            static void Register(BenchmarksMap& benchmarks)
+            static void Register(BenchmarksClassDescriptors& classes, const std::string& className)
             {
-                BenchmarksClass_<ObjectsDescHead_> bm;
-                for (auto b : bm.GetBenchmarks())
-                    benchmarks.insert({BenchmarkId(bm.GetName(), b->GetName(), ObjectsDescHead_::GetName()), b});
-
-                BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDescTail_...>::Register(benchmarks);
+                classes.push_back(BenchmarksClassDescriptor(className, ObjectsDescHead_::GetName(), &LoadBenchmarksClass<BenchmarksClass_, ObjectsDescHead_>));
+                BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDescTail_...>::Register(classes, className);
             }
         };
+
+
+        BenchmarksClassDescriptors& GetStaticBenchmarksClasses();
+
+        template < template <typename> class BenchmarksClass_, typename... ObjectsDesc_ >
+        struct StaticBenchmarksRegistrar
+        {
+            StaticBenchmarksRegistrar(const std::string& className)
+            { BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDesc_...>::Register(GetStaticBenchmarksClasses(), className); }
+        };
     }
 
 
+#define BENCHMARKS_DETAIL_CONCAT_IMPL(A_, B_) A_##B_
+#define BENCHMARKS_DETAIL_CONCAT(A_, B_) BENCHMARKS_DETAIL_CONCAT_IMPL(A_, B_)
+
+// Registers BenchmarksClass_<ObjectsDesc> for every objects descriptor in the suite created by RunBenchmarkApp(argc, argv),
+// ClassName_ must match the name the class passes to the BenchmarksClass constructor
+#define BENCHMARKS_REGISTER_CLASS(ClassName_, BenchmarksClass_, ...) \
+    static ::benchmarks::detail::StaticBenchmarksRegistrar<BenchmarksClass_, __VA_ARGS__> BENCHMARKS_DETAIL_CONCAT(s_benchmarksRegistrar, __LINE__)(ClassName_)
+
+
     struct IBenchmarksResultsReporter
     {
         virtual ~IBenchmarksResultsReporter() { }
 
         virtual void ReportOperationDuration(const std::string& name, double ns) = 0;
         virtual void ReportMemoryConsumption(const std::string& name, int64_t bytes) = 0;
+        virtual void ReportMetric(const std::string& name, double value) = 0;
+        virtual void ReportCounter(const std::string& name, const std::string& counter, double valuePerOperation) = 0;
+        virtual void ReportOperationStatistics(const std::string& name, const SampleStatistics& statistics) = 0;
+        virtual void ReportMemoryTimeline(const std::string& name, const MemoryTimeline& timeline) = 0;
+        virtual void ReportLatencies(const std::string& name, const HdrHistogram& latencies) = 0;
+        virtual void ReportWarning(const std::string& name, const std::string& message) = 0;
     };
     using IBenchmarksResultsReporterPtr = std::shared_ptr<IBenchmarksResultsReporter>;
 
@@ -62,22 +119,55 @@ namespace benchmarks
     class BenchmarkSuite
     {
         using BenchmarksMap = std::map<BenchmarkId, IBenchmarkPtr>;
+        using ScalingPoints = std::map<std::string, std::vector<std::pair<double, double>>>;
+        using OverheadsMap = std::map<std::pair<bool, bool>, MeasurementOverhead>;
+        using CalibrationsMap = std::map<std::string, int64_t>;
 
     private:
-        class PreMeasureBenchmarkContext;
         class MeasureBenchmarkContext;
+        class SamplesCollector;
+        using SamplesCollectorPtr = std::shared_ptr<SamplesCollector>;
+
+    public:
+        using ClassFilter = std::function<bool(const std::string& className, const std::string& objectName)>;
 
     private:
-        static NamedLogger  s_logger;
-        BenchmarksMap       _benchmarks;
+        static NamedLogger                                  s_logger;
+        mutable std::mutex                                  _classesMutex;
+        mutable detail::BenchmarksClassDescriptors          _classes;
+        mutable BenchmarksMap                               _benchmarks;
+        mutable std::mutex                                  _overheadsMutex;
+        mutable OverheadsMap                                _overheads;
+        mutable std::mutex                                  _calibrationsMutex;
+        mutable CalibrationsMap                             _calibrations;
 
     public:
+        // The class name is only needed to resolve a benchmark without instantiating unrelated classes
         template < template <typename> class BenchmarksClass_, typename... ObjectsDesc_ >
-        void RegisterBenchmarks()
-        { detail::BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDesc_...>::Register(_benchmarks); }
+        void RegisterBenchmarks(const std::string& className = std::string())
+        {
+            std::lock_guard<std::mutex> l(_classesMutex);
+            detail::BenchmarksClassRegistrar<BenchmarksClass_, ObjectsDesc_...>::Register(_classes, className);
+        }
+
+        void RegisterStaticBenchmarks();
+
+        std::vector<BenchmarkId> GetBenchmarkIds(const ClassFilter& filter = ClassFilter()) const;
 
-        int64_t MeasureIterationsCount(const ParameterizedBenchmarkId& id) const;
-        void InvokeBenchmark(int64_t iterations, const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter) const;
+        int64_t MeasureIterationsCount(const ParameterizedBenchmarkId& id, const MeasurementOptions& options = MeasurementOptions()) const;
+        void InvokeBenchmark(int64_t iterations, const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter, const MeasurementOptions& options = MeasurementOptions()) const;
+        int64_t MeasureAndInvokeBenchmark(const ParameterizedBenchmarkId& id, const IBenchmarksResultsReporterPtr& resultsReporter, const MeasurementOptions& options = MeasurementOptions()) const;
+
+        // Measured once for every combination of the options that change the work done by a profiled scope
+        const MeasurementOverhead& GetMeasurementOverhead(const MeasurementOptions& options = MeasurementOptions()) const;
+
+    private:
+        void LoadClass(detail::BenchmarksClassDescriptor& c) const;
+        const IBenchmarkPtr& GetBenchmark(const BenchmarkId& id) const;
+        int64_t Calibrate(const ParameterizedBenchmarkId& id, const MeasurementOptions& options, SamplesCollectorPtr& lastRound) const;
+        MeasurementOverhead MeasureOverhead(const MeasurementOptions& options) const;
+        void CollectSamples(int64_t iterations, const ParameterizedBenchmarkId& id, const MeasurementOptions& options, int numSamples, const SamplesCollectorPtr& collector, ScalingPoints& scalingPoints) const;
+        static void CheckScaling(const ScalingPoints& points, IBenchmarksResultsReporter& reporter);
     };
 }
 
@@ -0,0 +1,141 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/alloc_tracker/AllocTracker.hpp>
+
+#include <new>
+
+#include <errno.h>
+#include <stdlib.h>
+
+
+namespace
+{
+    // initial-exec, because a global-dynamic access may go through __tls_get_addr, which calls malloc. That is why the
+    // tracker has to be linked into the executable (or preloaded) rather than into a dlopen-ed library. Allocations made
+    // by dlopen-ed code are counted as long as it binds malloc to the executable, i.e. is not loaded with RTLD_DEEPBIND.
+    __thread BenchmarksAllocationCounters g_counters __attribute__((tls_model("initial-exec")));
+
+    inline void* CountAlloc(void* p, size_t size)
+    {
+        if (p)
+        {
+            ++g_counters.allocs;
+            g_counters.bytes += size;
+        }
+        return p;
+    }
+
+    inline void CountFree(void* p)
+    {
+        if (p)
+            ++g_counters.frees;
+    }
+}
+
+
+extern "C" const BenchmarksAllocationCounters* benchmarks_get_thread_allocation_counters()
+{ return &g_counters; }
+
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t num, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void* __libc_valloc(size_t size);
+    void* __libc_pvalloc(size_t size);
+    void __libc_free(void* p);
+
+    void* malloc(size_t size)
+    { return CountAlloc(__libc_malloc(size), size); }
+
+    void* calloc(size_t num, size_t size)
+    { return CountAlloc(__libc_calloc(num, size), num * size); }
+
+    void* realloc(void* p, size_t size)
+    {
+        void* result = __libc_realloc(p, size);
+        if (result || size == 0)
+            CountFree(p);
+        return CountAlloc(result, size);
+    }
+
+    void* reallocarray(void* p, size_t num, size_t size)
+    {
+        if (size != 0 && num > (size_t)-1 / size)
+        {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        return realloc(p, num * size);
+    }
+
+    void* valloc(size_t size)
+    { return CountAlloc(__libc_valloc(size), size); }
+
+    void* pvalloc(size_t size)
+    { return CountAlloc(__libc_pvalloc(size), size); }
+
+    void* memalign(size_t alignment, size_t size)
+    { return CountAlloc(__libc_memalign(alignment, size), size); }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    { return CountAlloc(__libc_memalign(alignment, size), size); }
+
+    int posix_memalign(void** p, size_t alignment, size_t size)
+    {
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void* result = CountAlloc(__libc_memalign(alignment, size), size);
+        if (!result)
+            return ENOMEM;
+        *p = result;
+        return 0;
+    }
+
+    void free(void* p)
+    {
+        CountFree(p);
+        __libc_free(p);
+    }
+}
+
+#else
+
+namespace
+{
+    void* AllocOrThrow(size_t size)
+    {
+        void* p = CountAlloc(malloc(size == 0 ? 1 : size), size);
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    void Free(void* p)
+    {
+        CountFree(p);
+        free(p);
+    }
+}
+
+void* operator new(size_t size) { return AllocOrThrow(size); }
+void* operator new[](size_t size) { return AllocOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountAlloc(malloc(size == 0 ? 1 : size), size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountAlloc(malloc(size == 0 ? 1 : size), size); }
+void operator delete(void* p) noexcept { Free(p); }
+void operator delete[](void* p) noexcept { Free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { Free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { Free(p); }
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef BENCHMARKS_ALLOC_TRACKER_ALLOCTRACKER_HPP
+#define BENCHMARKS_ALLOC_TRACKER_ALLOCTRACKER_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <stdint.h>
+
+
+extern "C"
+{
+    struct BenchmarksAllocationCounters
+    {
+        int64_t     allocs;
+        int64_t     frees;
+        int64_t     bytes;
+    };
+
+    const BenchmarksAllocationCounters* benchmarks_get_thread_allocation_counters();
+}
+
+#endif
@@ -35,6 +35,9 @@ namespace benchmarks
     {
         MergeMaps(_operationTimes, other._operationTimes);
         MergeMaps(_memoryConsumption, other._memoryConsumption);
+        _metrics.insert(other._metrics.begin(), other._metrics.end());
+        for (auto p : other._counters)
+            MergeMaps(_counters[p.first], p.second);
     }
 
 }
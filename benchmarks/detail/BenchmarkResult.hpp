@@ -11,8 +11,15 @@
 // WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 
+#include <benchmarks/utils/HdrHistogram.hpp>
+#include <benchmarks/utils/RssSampler.hpp>
+#include <benchmarks/utils/Statistics.hpp>
+
 #include <map>
 #include <string>
+#include <vector>
+
+#include <stdint.h>
 
 
 namespace benchmarks
@@ -23,10 +30,22 @@ namespace benchmarks
     public:
         using OperationTimesMap = std::map<std::string, double>;
         using MemoryConsumptionMap = std::map<std::string, int64_t>;
+        using MetricsMap = std::map<std::string, double>;
+        using CountersMap = std::map<std::string, std::map<std::string, double>>;
+        using StatisticsMap = std::map<std::string, SampleStatistics>;
+        using MemoryTimelinesMap = std::map<std::string, MemoryTimeline>;
+        using LatenciesMap = std::map<std::string, HdrHistogram>;
+        using WarningsMap = std::map<std::string, std::vector<std::string>>;
 
     private:
         OperationTimesMap       _operationTimes;
         MemoryConsumptionMap    _memoryConsumption;
+        MetricsMap              _metrics;
+        CountersMap             _counters;
+        StatisticsMap           _statistics;
+        MemoryTimelinesMap      _memoryTimelines;
+        LatenciesMap            _latencies;
+        WarningsMap             _warnings;
 
     public:
         BenchmarkResult() { }
@@ -37,6 +56,21 @@ namespace benchmarks
 
         const OperationTimesMap& GetOperationTimes() const { return _operationTimes; }
         const MemoryConsumptionMap& GetMemoryConsumption() const { return _memoryConsumption; }
+        const MetricsMap& GetMetrics() const { return _metrics; }
+        const CountersMap& GetCounters() const { return _counters; }
+        const StatisticsMap& GetStatistics() const { return _statistics; }
+        const MemoryTimelinesMap& GetMemoryTimelines() const { return _memoryTimelines; }
+        const LatenciesMap& GetLatencies() const { return _latencies; }
+        const WarningsMap& GetWarnings() const { return _warnings; }
+
+        void SetOperationTime(const std::string& name, double ns) { _operationTimes[name] = ns; }
+        void SetMemoryConsumption(const std::string& name, int64_t bytes) { _memoryConsumption[name] = bytes; }
+        void SetMetric(const std::string& name, double value) { _metrics[name] = value; }
+        void SetCounter(const std::string& name, const std::string& counter, double valuePerOperation) { _counters[name][counter] = valuePerOperation; }
+        void SetStatistics(const std::string& name, SampleStatistics statistics) { _statistics[name] = std::move(statistics); }
+        void SetMemoryTimeline(const std::string& name, MemoryTimeline timeline) { _memoryTimelines[name] = std::move(timeline); }
+        void SetLatencies(const std::string& name, const HdrHistogram& latencies) { _latencies.erase(name); _latencies.insert({name, latencies}); }
+        void AddWarning(const std::string& name, const std::string& message) { _warnings[name].push_back(message); }
 
         void Update(const BenchmarkResult& other);
     };
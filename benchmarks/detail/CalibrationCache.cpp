@@ -0,0 +1,108 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/detail/CalibrationCache.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#elif defined(__APPLE__) && defined(__MACH__)
+#   include <mach-o/dyld.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    BENCHMARKS_LOGGER(CalibrationCache);
+
+
+    CalibrationCache::CalibrationCache(std::string path)
+        : _path(std::move(path)), _binaryHash(GetBinaryHash())
+    {
+        std::ifstream f(_path);
+        std::string line;
+        while (std::getline(f, line))
+        {
+            std::stringstream s(line);
+            std::string hash, id;
+            int64_t iterations = 0;
+            if (!(s >> hash >> iterations) || hash != _binaryHash)
+                continue;
+            std::getline(s >> std::ws, id);
+            _iterations[id] = iterations;
+        }
+        s_logger.Debug() << "Binary hash: " << _binaryHash << ", " << _iterations.size() << " cached entries";
+    }
+
+
+    bool CalibrationCache::Find(const ParameterizedBenchmarkId& id, int64_t& iterations) const
+    {
+        auto it = _iterations.find(id.ToString());
+        if (it == _iterations.end())
+            return false;
+        iterations = it->second;
+        return true;
+    }
+
+
+    void CalibrationCache::Store(const ParameterizedBenchmarkId& id, int64_t iterations)
+    {
+        auto id_str = id.ToString();
+        _iterations[id_str] = iterations;
+
+        std::ofstream f(_path, std::ios_base::app);
+        f << _binaryHash << " " << iterations << " " << id_str << std::endl;
+        if (!f)
+            s_logger.Warning() << "Could not write to " << _path;
+    }
+
+
+    std::string CalibrationCache::GetBinaryHash()
+    {
+        std::string exe_path;
+#if defined(_WIN32)
+        char path_buf[MAX_PATH] = { '\0' };
+        if (GetModuleFileNameA(NULL, path_buf, sizeof(path_buf)))
+            exe_path = path_buf;
+#elif defined(__APPLE__) && defined(__MACH__)
+        char path_buf[4096] = { '\0' };
+        uint32_t size = sizeof(path_buf);
+        if (_NSGetExecutablePath(path_buf, &size) == 0)
+            exe_path = path_buf;
+#else
+        exe_path = "/proc/self/exe";
+#endif
+
+        std::ifstream f(exe_path, std::ios_base::binary);
+        if (!f)
+            throw std::runtime_error("Could not open the executable file to compute its hash!");
+
+        uint64_t hash = 14695981039346656037ULL;
+        std::vector<char> buf(1 << 16);
+        while (f.read(buf.data(), buf.size()) || f.gcount() > 0)
+        {
+            for (std::streamsize i = 0; i < f.gcount(); ++i)
+            {
+                hash ^= (unsigned char)buf[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        std::stringstream s;
+        s << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return s.str();
+    }
+
+}
@@ -0,0 +1,47 @@
+#ifndef BENCHMARKS_CORE_DETAIL_CALIBRATIONCACHE_HPP
+#define BENCHMARKS_CORE_DETAIL_CALIBRATIONCACHE_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/detail/ParameterizedBenchmarkId.hpp>
+#include <benchmarks/utils/Logger.hpp>
+
+#include <map>
+#include <string>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    class CalibrationCache
+    {
+    private:
+        static NamedLogger                      s_logger;
+
+        std::string                             _path;
+        std::string                             _binaryHash;
+        std::map<std::string, int64_t>          _iterations;
+
+    public:
+        CalibrationCache(std::string path);
+
+        bool Find(const ParameterizedBenchmarkId& id, int64_t& iterations) const;
+        void Store(const ParameterizedBenchmarkId& id, int64_t iterations);
+
+    private:
+        static std::string GetBinaryHash();
+    };
+
+}
+
+#endif
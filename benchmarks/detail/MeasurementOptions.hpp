@@ -0,0 +1,47 @@
+#ifndef BENCHMARKS_CORE_DETAIL_MEASUREMENTOPTIONS_HPP
+#define BENCHMARKS_CORE_DETAIL_MEASUREMENTOPTIONS_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/AllocationPolicy.hpp>
+#include <benchmarks/utils/MemoryProbe.hpp>
+#include <benchmarks/utils/Statistics.hpp>
+#include <benchmarks/utils/SystemMonitor.hpp>
+
+#include <chrono>
+
+
+namespace benchmarks
+{
+
+    struct MeasurementOptions
+    {
+        bool            perfCounters;
+        int             samples;
+        OutlierRule     outlierRule;
+        double          confidence;
+        int             bootstrapResamples;
+        MemorySource                memorySource;
+        std::chrono::microseconds   memoryTimelineInterval;
+        NoisePolicy                 noisePolicy;
+        double                      maxFrequencyDrift;
+        bool                        subtractOverhead;
+        AllocationPolicy            allocationPolicy;
+
+        MeasurementOptions()
+            : perfCounters(false), samples(1), confidence(0.95), bootstrapResamples(1000), memorySource(MemorySource::Rss), memoryTimelineInterval(0),
+              noisePolicy(NoisePolicy::Warn), maxFrequencyDrift(0.05), subtractOverhead(false)
+        { }
+    };
+
+}
+
+#endif
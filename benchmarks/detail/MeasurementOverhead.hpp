@@ -0,0 +1,39 @@
+#ifndef BENCHMARKS_CORE_DETAIL_MEASUREMENTOVERHEAD_HPP
+#define BENCHMARKS_CORE_DETAIL_MEASUREMENTOVERHEAD_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <algorithm>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    // Time the framework adds to a profiled scope, to a single iteration of an empty benchmark loop and to an operation
+    // timed by ProfileEach
+    struct MeasurementOverhead
+    {
+        double      scopeNs;
+        double      iterationNs;
+        double      eachOperationNs;
+
+        MeasurementOverhead() : scopeNs(0), iterationNs(0), eachOperationNs(0) { }
+        MeasurementOverhead(double scopeNs, double iterationNs, double eachOperationNs) : scopeNs(scopeNs), iterationNs(iterationNs), eachOperationNs(eachOperationNs) { }
+
+        double Subtract(double ns, int64_t count, double operationNs) const
+        { return std::max(0.0, (ns - scopeNs) / count - operationNs); }
+    };
+
+}
+
+#endif
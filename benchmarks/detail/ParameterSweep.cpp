@@ -0,0 +1,154 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/detail/ParameterSweep.hpp>
+
+#include <limits>
+#include <stdexcept>
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        bool ParseRangeBound(const std::string& str, const std::string& spec, int64_t& result)
+        {
+            if (str.empty())
+                return false;
+
+            size_t pos = 0;
+            try
+            { result = std::stoll(str, &pos); }
+            catch (const std::invalid_argument&)
+            { return false; }
+            catch (const std::out_of_range&)
+            { throw std::runtime_error("Parameter value '" + str + "' is out of range: '" + spec + "'"); }
+
+            int64_t factor = 1;
+            if (pos + 1 == str.size())
+            {
+                switch (str[pos])
+                {
+                case 'k': case 'K': factor = (int64_t)1 << 10; break;
+                case 'M': factor = (int64_t)1 << 20; break;
+                case 'G': factor = (int64_t)1 << 30; break;
+                default: return false;
+                }
+            }
+            else if (pos != str.size())
+                return false;
+
+            if (result < 0)
+                throw std::runtime_error("Parameter value '" + str + "' is negative: '" + spec + "'");
+            if (result > std::numeric_limits<int64_t>::max() / factor)
+                throw std::runtime_error("Parameter value '" + str + "' is out of range: '" + spec + "'");
+            result *= factor;
+            return true;
+        }
+
+        std::string Trim(const std::string& str)
+        {
+            auto begin = str.find_first_not_of(" \t");
+            if (begin == std::string::npos)
+                return std::string();
+            return str.substr(begin, str.find_last_not_of(" \t") - begin + 1);
+        }
+    }
+
+
+    ParameterSweep::ParameterSweep(const SerializedParamsMap& specs)
+        : _specs(specs)
+    {
+        for (auto&& p : specs)
+            _values[p.first] = ExpandValues(p.second);
+    }
+
+
+    std::vector<std::string> ParameterSweep::GetSweptParameters() const
+    {
+        std::vector<std::string> result;
+        for (auto&& p : _values)
+            if (p.second.size() > 1)
+                result.push_back(p.first);
+        return result;
+    }
+
+
+    std::vector<SerializedParamsMap> ParameterSweep::GetCombinations() const
+    {
+        std::vector<SerializedParamsMap> result(1);
+        for (auto&& p : _values)
+        {
+            std::vector<SerializedParamsMap> extended;
+            for (auto&& combination : result)
+                for (auto&& value : p.second)
+                {
+                    extended.push_back(combination);
+                    extended.back()[p.first] = value;
+                }
+            result.swap(extended);
+        }
+        return result;
+    }
+
+
+    std::vector<SerializedParam> ParameterSweep::ExpandValues(const std::string& spec)
+    {
+        std::vector<SerializedParam> result;
+
+        if (spec.size() >= 2 && spec.front() == '[' && spec.back() == ']')
+        {
+            std::string list = spec.substr(1, spec.size() - 2);
+            size_t pos = 0;
+            while (true)
+            {
+                auto delim_pos = list.find(',', pos);
+                auto value = Trim(list.substr(pos, delim_pos == std::string::npos ? std::string::npos : delim_pos - pos));
+                if (value.empty())
+                    throw std::runtime_error("Empty value in parameter list '" + spec + "'");
+                int64_t number = 0;
+                result.push_back(ParseRangeBound(value, spec, number) ? std::to_string(number) : value);
+                if (delim_pos == std::string::npos)
+                    return result;
+                pos = delim_pos + 1;
+            }
+        }
+
+        auto range_pos = spec.find("..");
+        if (range_pos == std::string::npos)
+            return { spec };
+
+        auto to_str = spec.substr(range_pos + 2);
+        auto step_pos = to_str.find_first_of("*+");
+        char step_kind = step_pos == std::string::npos ? '*' : to_str[step_pos];
+        int64_t from = 0, to = 0, step = 2;
+        if (!ParseRangeBound(spec.substr(0, range_pos), spec, from) || !ParseRangeBound(to_str.substr(0, step_pos), spec, to))
+            return { spec };
+        if (step_pos != std::string::npos && !ParseRangeBound(to_str.substr(step_pos + 1), spec, step))
+            throw std::runtime_error("Invalid parameter range step: '" + spec + "'");
+
+        if (from > to)
+            throw std::runtime_error("Invalid parameter range: '" + spec + "'");
+        if (step_kind == '*' ? (step < 2 || from <= 0) : step < 1)
+            throw std::runtime_error("Parameter range does not progress: '" + spec + "'");
+
+        for (int64_t value = from; value < to; )
+        {
+            result.push_back(std::to_string(value));
+            // The next value would overshoot (and possibly overflow), the range ends with 'to'
+            if (step_kind == '*' ? value > to / step : value > to - step)
+                break;
+            value = step_kind == '*' ? value * step : value + step;
+        }
+        result.push_back(std::to_string(to));
+        return result;
+    }
+
+}
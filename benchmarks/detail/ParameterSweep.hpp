@@ -0,0 +1,49 @@
+#ifndef BENCHMARKS_CORE_DETAIL_PARAMETERSWEEP_HPP
+#define BENCHMARKS_CORE_DETAIL_PARAMETERSWEEP_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/Benchmark.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace benchmarks
+{
+
+    class ParameterSweep
+    {
+    private:
+        SerializedParamsMap                                 _specs;
+        std::map<std::string, std::vector<SerializedParam>> _values;
+
+    public:
+        ParameterSweep()
+        { }
+
+        ParameterSweep(const SerializedParamsMap& specs);
+
+        const SerializedParamsMap& GetSpecs() const { return _specs; }
+
+        std::vector<std::string> GetSweptParameters() const;
+        std::vector<SerializedParamsMap> GetCombinations() const;
+
+        // Expands 'from..to', 'from..to*factor', 'from..to+step' and '[a,b,c]', other values are left as is.
+        // Range bounds and numeric list values accept k, M and G (binary) suffixes, negative numbers are rejected.
+        // Multiplicative ranges are used if no step is specified.
+        static std::vector<SerializedParam> ExpandValues(const std::string& spec);
+    };
+
+}
+
+#endif
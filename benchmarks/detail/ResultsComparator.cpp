@@ -0,0 +1,190 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/detail/ResultsComparator.hpp>
+
+#include <benchmarks/utils/Statistics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+namespace benchmarks
+{
+
+    std::string ComparisonVerdictToString(ComparisonVerdict verdict)
+    {
+        switch (verdict)
+        {
+        case ComparisonVerdict::NoChange: return "no_change";
+        case ComparisonVerdict::Improvement: return "improvement";
+        case ComparisonVerdict::Regression: return "regression";
+        default: return "inconclusive";
+        }
+    }
+
+
+    void ResultsComparator::CollectSamples(const JsonValue& result, SamplesMap& samples)
+    {
+        if (result.Has("times"))
+            for (auto&& p : result.Get("times").AsObject())
+            {
+                auto& dst = samples["times." + p.first];
+                if (result.Has("statistics") && result.Get("statistics").Has(p.first))
+                    for (auto&& s : result.Get("statistics").Get(p.first).Get("samples").AsArray())
+                        dst.push_back(s.AsNumber());
+                else
+                    dst.push_back(p.second.AsNumber());
+            }
+
+        if (result.Has("memory"))
+            for (auto&& p : result.Get("memory").AsObject())
+                samples["memory." + p.first].push_back(p.second.AsNumber());
+    }
+
+
+    std::vector<MetricComparison> ResultsComparator::Compare(const SamplesMap& reference, const SamplesMap& current) const
+    {
+        std::vector<MetricComparison> result;
+
+        std::mt19937 rng(12345);
+        for (auto&& r : reference)
+        {
+            auto it = current.find(r.first);
+            if (it == current.end() || r.second.empty() || it->second.empty())
+                continue;
+
+            const auto& ref = r.second;
+            const auto& cur = it->second;
+
+            MetricComparison c;
+            c.metric = r.first;
+            c.referenceCount = ref.size();
+            c.currentCount = cur.size();
+            c.referenceMedian = Median(ref);
+            c.currentMedian = Median(cur);
+            c.effect = c.referenceMedian != 0 ? c.currentMedian / c.referenceMedian - 1 : 0;
+            c.pValue = MannWhitneyUTest(ref, cur).pValue;
+
+            std::vector<double> effects, ref_resample(ref.size()), cur_resample(cur.size());
+            std::uniform_int_distribution<size_t> ref_dist(0, ref.size() - 1), cur_dist(0, cur.size() - 1);
+            for (int i = 0; i < _options.bootstrapResamples; ++i)
+            {
+                for (auto& v : ref_resample)
+                    v = ref[ref_dist(rng)];
+                for (auto& v : cur_resample)
+                    v = cur[cur_dist(rng)];
+                double ref_median = Median(ref_resample);
+                effects.push_back(ref_median != 0 ? Median(cur_resample) / ref_median - 1 : 0);
+            }
+            std::sort(effects.begin(), effects.end());
+            c.effectCiLow = effects.empty() ? c.effect : Quantile(effects, (1 - _options.confidence) / 2);
+            c.effectCiHigh = effects.empty() ? c.effect : Quantile(effects, (1 + _options.confidence) / 2);
+
+            result.push_back(c);
+        }
+
+        SetVerdicts(result);
+        return result;
+    }
+
+
+    std::vector<MetricComparison> ResultsComparator::ComparePaired(const SamplesMap& reference, const SamplesMap& current) const
+    {
+        std::vector<MetricComparison> result;
+
+        std::mt19937 rng(12345);
+        for (auto&& r : reference)
+        {
+            auto it = current.find(r.first);
+            if (it == current.end())
+                continue;
+
+            size_t num_pairs = std::min(r.second.size(), it->second.size());
+            std::vector<double> ref(r.second.begin(), r.second.begin() + num_pairs), cur(it->second.begin(), it->second.begin() + num_pairs);
+            std::vector<double> differences;
+            for (size_t i = 0; i < num_pairs; ++i)
+                differences.push_back(ref[i] != 0 ? cur[i] / ref[i] - 1 : 0);
+            if (differences.empty())
+                continue;
+
+            MetricComparison c;
+            c.metric = r.first;
+            c.referenceCount = c.currentCount = num_pairs;
+            c.referenceMedian = Median(ref);
+            c.currentMedian = Median(cur);
+            c.effect = Median(differences);
+            c.pValue = WilcoxonSignedRankTest(differences);
+
+            std::vector<double> effects, resample(differences.size());
+            std::uniform_int_distribution<size_t> index_dist(0, differences.size() - 1);
+            for (int i = 0; i < _options.bootstrapResamples; ++i)
+            {
+                for (auto& v : resample)
+                    v = differences[index_dist(rng)];
+                effects.push_back(Median(resample));
+            }
+            std::sort(effects.begin(), effects.end());
+            c.effectCiLow = effects.empty() ? c.effect : Quantile(effects, (1 - _options.confidence) / 2);
+            c.effectCiHigh = effects.empty() ? c.effect : Quantile(effects, (1 + _options.confidence) / 2);
+
+            result.push_back(c);
+        }
+
+        SetVerdicts(result);
+        return result;
+    }
+
+
+    void ResultsComparator::SetVerdicts(std::vector<MetricComparison>& comparisons) const
+    {
+        std::vector<double> p_values;
+        for (auto&& c : comparisons)
+            p_values.push_back(c.pValue);
+
+        auto adjusted = HolmCorrection(p_values);
+        for (size_t i = 0; i < comparisons.size(); ++i)
+        {
+            auto& c = comparisons[i];
+            c.adjustedPValue = adjusted[i];
+
+            bool significant = c.adjustedPValue < _options.alpha;
+            bool equivalent = c.effectCiLow > -_options.minEffect && c.effectCiHigh < _options.minEffect;
+            if (significant && std::fabs(c.effect) >= _options.minEffect)
+                c.verdict = c.effect > 0 ? ComparisonVerdict::Regression : ComparisonVerdict::Improvement;
+            else if (significant || equivalent)
+                c.verdict = ComparisonVerdict::NoChange;
+            else
+                c.verdict = ComparisonVerdict::Inconclusive;
+        }
+    }
+
+
+    JsonValue ResultsComparator::ToJson(const std::vector<MetricComparison>& comparisons)
+    {
+        JsonValue result = JsonValue::Object();
+        for (auto&& c : comparisons)
+        {
+            JsonValue& entry = result[c.metric];
+            entry["reference"] = c.referenceMedian;
+            entry["current"] = c.currentMedian;
+            entry["reference_count"] = (int64_t)c.referenceCount;
+            entry["current_count"] = (int64_t)c.currentCount;
+            entry["effect"] = c.effect;
+            entry["effect_ci_low"] = c.effectCiLow;
+            entry["effect_ci_high"] = c.effectCiHigh;
+            entry["p_value"] = c.pValue;
+            entry["adjusted_p_value"] = c.adjustedPValue;
+            entry["verdict"] = ComparisonVerdictToString(c.verdict);
+        }
+        return result;
+    }
+
+}
@@ -0,0 +1,98 @@
+#ifndef BENCHMARKS_CORE_DETAIL_RESULTSCOMPARATOR_HPP
+#define BENCHMARKS_CORE_DETAIL_RESULTSCOMPARATOR_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Json.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace benchmarks
+{
+
+    enum class ComparisonVerdict
+    {
+        NoChange,
+        Improvement,
+        Regression,
+        Inconclusive
+    };
+
+    std::string ComparisonVerdictToString(ComparisonVerdict verdict);
+
+
+    struct ComparisonOptions
+    {
+        double      alpha;
+        double      minEffect;          // relative change of the median below which differences are not reported
+        double      confidence;
+        int         bootstrapResamples;
+
+        ComparisonOptions()
+            : alpha(0.05), minEffect(0.03), confidence(0.95), bootstrapResamples(1000)
+        { }
+    };
+
+
+    struct MetricComparison
+    {
+        std::string             metric;
+        size_t                  referenceCount;
+        size_t                  currentCount;
+        double                  referenceMedian;
+        double                  currentMedian;
+        double                  effect;         // currentMedian / referenceMedian - 1, the median of the paired relative differences for paired comparisons
+        double                  effectCiLow;
+        double                  effectCiHigh;
+        double                  pValue;
+        double                  adjustedPValue;
+        ComparisonVerdict       verdict;
+
+        MetricComparison()
+            : referenceCount(0), currentCount(0), referenceMedian(0), currentMedian(0), effect(0), effectCiLow(0), effectCiHigh(0), pValue(1), adjustedPValue(1), verdict(ComparisonVerdict::Inconclusive)
+        { }
+    };
+
+
+    // Compares the times and memory consumption (lower is better) of two sets of benchmark results
+    class ResultsComparator
+    {
+    public:
+        using SamplesMap = std::map<std::string, std::vector<double>>;
+
+    private:
+        ComparisonOptions       _options;
+
+    public:
+        ResultsComparator(const ComparisonOptions& options = ComparisonOptions())
+            : _options(options)
+        { }
+
+        // Uses the statistics samples when present, the reported values otherwise
+        static void CollectSamples(const JsonValue& result, SamplesMap& samples);
+
+        std::vector<MetricComparison> Compare(const SamplesMap& reference, const SamplesMap& current) const;
+
+        // The samples of each metric are pairs measured next to each other, missing pairs are dropped
+        std::vector<MetricComparison> ComparePaired(const SamplesMap& reference, const SamplesMap& current) const;
+
+        static JsonValue ToJson(const std::vector<MetricComparison>& comparisons);
+
+    private:
+        void SetVerdicts(std::vector<MetricComparison>& comparisons) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,397 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/detail/ResultsStore.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <io.h>
+#else
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/file.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        const char      StoreMagic[4] = { 'B', 'M', 'R', 'S' };
+        const char      RecordMagic[4] = { 'B', 'M', 'R', 'R' };
+        const uint32_t  StoreVersion = 2;
+
+        enum class RecordKind : uint32_t
+        {
+            Environment = 1,
+            Measurement = 2
+        };
+
+        struct RecordPrefix
+        {
+            char        magic[4];
+            uint32_t    kind;
+            uint32_t    payloadSize;
+            uint32_t    checksum;
+        };
+
+        struct MeasurementHeader
+        {
+            int64_t     timestamp;
+            double      value;
+            uint64_t    environmentId;
+            uint32_t    numSamples;
+            uint32_t    benchmarkSize;
+            uint32_t    measurementSize;
+            uint32_t    revisionSize;
+        };
+
+        const size_t FileHeaderSize = sizeof(StoreMagic) + sizeof(StoreVersion);
+
+
+        uint32_t Checksum(const char* data, size_t size)
+        {
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < size; ++i)
+                h = (h ^ (uint8_t)data[i]) * 16777619u;
+            return h;
+        }
+
+        uint64_t GetEnvironmentId(const std::string& environment)
+        {
+            if (environment.empty())
+                return 0;
+
+            uint64_t h = 14695981039346656037ull;
+            for (char c : environment)
+                h = (h ^ (uint8_t)c) * 1099511628211ull;
+            return h ? h : 1;
+        }
+
+
+        class MappedFile
+        {
+        private:
+            const char*         _data;
+            size_t              _size;
+#if defined(_WIN32)
+            std::vector<char>   _buf;
+#endif
+
+        public:
+            MappedFile(const std::string& path)
+                : _data(nullptr), _size(0)
+            {
+#if defined(_WIN32)
+                std::ifstream f(path, std::ios_base::binary);
+                _buf.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+                _data = _buf.data();
+                _size = _buf.size();
+#else
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return;
+
+                struct stat st;
+                if (fstat(fd, &st) == 0 && st.st_size > 0)
+                {
+                    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p != MAP_FAILED)
+                    {
+                        _data = (const char*)p;
+                        _size = (size_t)st.st_size;
+                    }
+                }
+                close(fd);
+#endif
+            }
+
+            ~MappedFile()
+            {
+#if !defined(_WIN32)
+                if (_data)
+                    munmap((void*)_data, _size);
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator = (const MappedFile&) = delete;
+
+            const char* GetData() const { return _data; }
+            size_t GetSize() const { return _size; }
+        };
+
+
+        // Holds an exclusive lock on the store while appending, so that the file header is written only by the
+        // process that finds the file empty and the records of concurrent writers do not interleave
+        class LockedStoreFile
+        {
+        private:
+            std::string     _path;
+            std::FILE*      _file;
+
+        public:
+            LockedStoreFile(const std::string& path)
+                : _path(path), _file(nullptr)
+            {
+#if defined(_WIN32)
+                _file = std::fopen(path.c_str(), "ab+");
+                if (!_file)
+                    throw std::runtime_error("Could not open results store " + path);
+                OVERLAPPED overlapped = { };
+                if (!LockFileEx((HANDLE)_get_osfhandle(_fileno(_file)), LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+                {
+                    std::fclose(_file);
+                    throw std::runtime_error("Could not lock results store " + path);
+                }
+#else
+                int fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+                if (fd < 0)
+                    throw std::runtime_error("Could not open results store " + path);
+                int res;
+                while ((res = flock(fd, LOCK_EX)) != 0 && errno == EINTR)
+                    ;
+                if (res != 0 || !(_file = fdopen(fd, "ab+")))
+                {
+                    close(fd);
+                    throw std::runtime_error("Could not lock results store " + path);
+                }
+#endif
+                std::setvbuf(_file, nullptr, _IONBF, 0);
+            }
+
+            ~LockedStoreFile()
+            {
+#if defined(_WIN32)
+                OVERLAPPED overlapped = { };
+                UnlockFileEx((HANDLE)_get_osfhandle(_fileno(_file)), 0, MAXDWORD, MAXDWORD, &overlapped);
+#endif
+                std::fclose(_file);
+            }
+
+            LockedStoreFile(const LockedStoreFile&) = delete;
+            LockedStoreFile& operator = (const LockedStoreFile&) = delete;
+
+            void WriteFileHeaderIfEmpty()
+            {
+                if (std::fseek(_file, 0, SEEK_END) != 0)
+                    throw std::runtime_error("Could not write to results store " + _path);
+                if (std::ftell(_file) != 0)
+                    return;
+
+                std::vector<char> file_header(StoreMagic, StoreMagic + sizeof(StoreMagic));
+                file_header.insert(file_header.end(), (const char*)&StoreVersion, (const char*)&StoreVersion + sizeof(StoreVersion));
+                Write(file_header);
+            }
+
+            void Write(const std::vector<char>& buf)
+            {
+                if (std::fwrite(buf.data(), 1, buf.size(), _file) != buf.size())
+                    throw std::runtime_error("Could not write to results store " + _path);
+            }
+        };
+
+
+        template < typename T_ >
+        void WritePod(std::vector<char>& buf, const T_& val)
+        {
+            const char* p = (const char*)&val;
+            buf.insert(buf.end(), p, p + sizeof(T_));
+        }
+
+        void WriteRecord(std::vector<char>& buf, RecordKind kind, const std::vector<char>& payload)
+        {
+            RecordPrefix prefix;
+            std::memcpy(prefix.magic, RecordMagic, sizeof(RecordMagic));
+            prefix.kind = (uint32_t)kind;
+            prefix.payloadSize = (uint32_t)payload.size();
+            prefix.checksum = Checksum(payload.data(), payload.size());
+            WritePod(buf, prefix);
+            buf.insert(buf.end(), payload.begin(), payload.end());
+        }
+    }
+
+
+    BENCHMARKS_LOGGER(ResultsStore);
+
+
+    ResultsStore::ResultsStore(std::string path)
+        : _path(std::move(path))
+    { }
+
+
+    void ResultsStore::Append(const ResultsRecord& record)
+    {
+        std::vector<char> buf, payload;
+
+        uint64_t environment_id = GetEnvironmentId(record.environment);
+        bool new_environment = environment_id && _storedEnvironments.count(environment_id) == 0;
+        if (new_environment)
+        {
+            WritePod(payload, environment_id);
+            payload.insert(payload.end(), record.environment.begin(), record.environment.end());
+            WriteRecord(buf, RecordKind::Environment, payload);
+            payload.clear();
+        }
+
+        MeasurementHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.timestamp = record.timestamp;
+        header.value = record.value;
+        header.environmentId = environment_id;
+        header.numSamples = (uint32_t)record.samples.size();
+        header.benchmarkSize = (uint32_t)record.benchmark.size();
+        header.measurementSize = (uint32_t)record.measurement.size();
+        header.revisionSize = (uint32_t)record.revision.size();
+
+        WritePod(payload, header);
+        for (double s : record.samples)
+            WritePod(payload, s);
+        for (auto str : { &record.benchmark, &record.measurement, &record.revision })
+            payload.insert(payload.end(), str->begin(), str->end());
+        WriteRecord(buf, RecordKind::Measurement, payload);
+
+        LockedStoreFile f(_path);
+        f.WriteFileHeaderIfEmpty();
+        f.Write(buf);
+
+        if (new_environment)
+            _storedEnvironments.insert(environment_id);
+    }
+
+
+    void ResultsStore::Append(const ParameterizedBenchmarkId& id, const BenchmarkResult& result, const std::string& revision, const std::string& environment)
+    {
+        ResultsRecord record;
+        record.timestamp = (int64_t)std::time(nullptr);
+        record.benchmark = id.ToString();
+        record.revision = revision;
+        record.environment = environment;
+
+        for (auto&& p : result.GetOperationTimes())
+        {
+            record.measurement = p.first;
+            record.value = p.second;
+
+            auto it = result.GetStatistics().find(p.first);
+            if (it != result.GetStatistics().end())
+                record.samples = it->second.GetSamples();
+            else
+                record.samples.assign(1, p.second);
+
+            Append(record);
+        }
+    }
+
+
+    std::vector<ResultsRecord> ResultsStore::Read(const Filter& filter) const
+    {
+        std::vector<ResultsRecord> result;
+
+        MappedFile file(_path);
+        const char* data = file.GetData();
+        size_t size = file.GetSize();
+        if (!data)
+            return result;
+
+        if (size < FileHeaderSize || std::memcmp(data, StoreMagic, sizeof(StoreMagic)) != 0)
+            throw std::runtime_error(_path + " is not a results store!");
+
+        uint32_t version = 0;
+        std::memcpy(&version, data + sizeof(StoreMagic), sizeof(version));
+        if (version != StoreVersion)
+            throw std::runtime_error(_path + ": unsupported results store version " + std::to_string(version));
+
+        std::map<uint64_t, std::string> environments;
+        size_t skipped_bytes = 0;
+        size_t pos = FileHeaderSize;
+        while (pos < size)
+        {
+            RecordPrefix prefix;
+            const char* payload = data + pos + sizeof(prefix);
+            bool valid = pos + sizeof(prefix) <= size;
+            if (valid)
+            {
+                std::memcpy(&prefix, data + pos, sizeof(prefix));
+                valid = std::memcmp(prefix.magic, RecordMagic, sizeof(RecordMagic)) == 0
+                    && prefix.payloadSize <= size - pos - sizeof(prefix)
+                    && Checksum(payload, prefix.payloadSize) == prefix.checksum;
+            }
+
+            if (!valid)
+            {
+                auto next = std::search(data + pos + 1, data + size, RecordMagic, RecordMagic + sizeof(RecordMagic));
+                skipped_bytes += next - (data + pos);
+                pos = next - data;
+                continue;
+            }
+            pos += sizeof(prefix) + prefix.payloadSize;
+
+            if (prefix.kind == (uint32_t)RecordKind::Environment && prefix.payloadSize >= sizeof(uint64_t))
+            {
+                uint64_t environment_id = 0;
+                std::memcpy(&environment_id, payload, sizeof(environment_id));
+                environments[environment_id].assign(payload + sizeof(environment_id), prefix.payloadSize - sizeof(environment_id));
+                continue;
+            }
+
+            MeasurementHeader header;
+            if (prefix.kind != (uint32_t)RecordKind::Measurement || prefix.payloadSize < sizeof(header))
+                continue;
+
+            std::memcpy(&header, payload, sizeof(header));
+            size_t samples_size = header.numSamples * sizeof(double);
+            if (sizeof(header) + samples_size + (size_t)header.benchmarkSize + header.measurementSize + header.revisionSize != prefix.payloadSize)
+            {
+                s_logger.Warning() << _path << ": skipping a malformed record";
+                continue;
+            }
+
+            const char* str = payload + sizeof(header) + samples_size;
+            ResultsRecord record;
+            record.timestamp = header.timestamp;
+            record.value = header.value;
+            record.benchmark.assign(str, header.benchmarkSize);
+            str += header.benchmarkSize;
+            record.measurement.assign(str, header.measurementSize);
+            str += header.measurementSize;
+            record.revision.assign(str, header.revisionSize);
+
+            if (filter && !filter(record))
+                continue;
+
+            auto it = environments.find(header.environmentId);
+            if (it != environments.end())
+                record.environment = it->second;
+            record.samples.resize(header.numSamples);
+            if (samples_size)
+                std::memcpy(record.samples.data(), payload + sizeof(header), samples_size);
+            result.push_back(std::move(record));
+        }
+
+        if (skipped_bytes)
+            s_logger.Warning() << _path << ": skipped " << skipped_bytes << " bytes of corrupt or truncated records";
+
+        return result;
+    }
+
+}
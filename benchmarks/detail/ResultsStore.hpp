@@ -0,0 +1,75 @@
+#ifndef BENCHMARKS_CORE_DETAIL_RESULTSSTORE_HPP
+#define BENCHMARKS_CORE_DETAIL_RESULTSSTORE_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/detail/BenchmarkResult.hpp>
+#include <benchmarks/detail/MeasurementId.hpp>
+#include <benchmarks/utils/Logger.hpp>
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    struct ResultsRecord
+    {
+        int64_t                 timestamp;
+        std::string             benchmark;
+        std::string             measurement;
+        std::string             revision;
+        std::string             environment;
+        double                  value;
+        std::vector<double>     samples;
+
+        ResultsRecord() : timestamp(0), value(0) { }
+
+        std::string GetMeasurementId() const { return benchmark + "[" + measurement + "]"; }
+    };
+
+
+    // Append-only file of binary records that is memory mapped for queries:
+    //   file:   "BMRS" magic, uint32 version
+    //   record: "BMRR" magic, uint32 kind, uint32 payload size, uint32 payload checksum, payload
+    //   environment payload: uint64 environment id, environment string
+    //   measurement payload: int64 timestamp, double value, uint64 environment id, uint32 samples count and
+    //                        benchmark/measurement/revision string sizes, samples, strings
+    // The environment of a run is stored once and referenced by its hash, the record magic lets the reader resync after a
+    // corrupt or truncated record. Values are stored in the host byte order.
+    class ResultsStore
+    {
+    public:
+        using Filter = std::function<bool(const ResultsRecord&)>;
+
+    private:
+        static NamedLogger      s_logger;
+        std::string             _path;
+        std::set<uint64_t>      _storedEnvironments;
+
+    public:
+        ResultsStore(std::string path);
+
+        void Append(const ResultsRecord& record);
+        void Append(const ParameterizedBenchmarkId& id, const BenchmarkResult& result, const std::string& revision, const std::string& environment);
+
+        // Records are returned in the order they were appended, samples and environment are loaded only for the records that pass the filter
+        std::vector<ResultsRecord> Read(const Filter& filter = Filter()) const;
+    };
+
+}
+
+#endif
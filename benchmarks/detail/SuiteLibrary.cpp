@@ -0,0 +1,94 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/detail/SuiteLibrary.hpp>
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <dlfcn.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    SuiteLibrary::SuiteLibrary(std::string path)
+        : _path(std::move(path)), _handle(nullptr), _request(nullptr), _free(nullptr)
+    {
+#if defined(_WIN32)
+        _handle = LoadLibraryA(_path.c_str());
+        if (!_handle)
+            throw std::runtime_error("Could not load " + _path + ": error " + std::to_string(GetLastError()));
+#else
+        // Both builds define the same symbols and still use their own copies, since the host executable does not export
+        // them. RTLD_DEEPBIND is not used, it would bind malloc past the allocation tracker of the host.
+        _handle = dlopen(_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!_handle)
+            throw std::runtime_error("Could not load " + _path + ": " + dlerror());
+#endif
+
+        try
+        {
+            _request = (RequestFunc)GetSymbol("benchmarks_suite_request");
+            _free = (FreeFunc)GetSymbol("benchmarks_suite_free");
+        }
+        catch (...)
+        {
+#if defined(_WIN32)
+            FreeLibrary((HMODULE)_handle);
+#else
+            dlclose(_handle);
+#endif
+            throw;
+        }
+    }
+
+
+    SuiteLibrary::~SuiteLibrary()
+    {
+#if defined(_WIN32)
+        FreeLibrary((HMODULE)_handle);
+#else
+        dlclose(_handle);
+#endif
+    }
+
+
+    JsonValue SuiteLibrary::Request(const JsonValue& request) const
+    {
+        char* response_str = _request(request.ToString().c_str());
+        if (!response_str)
+            throw std::runtime_error(_path + ": no response");
+
+        std::string s(response_str);
+        _free(response_str);
+
+        JsonValue response = JsonValue::Parse(s);
+        if (response.Has("error"))
+            throw std::runtime_error(_path + ": " + response.Get("error").AsString());
+        return response;
+    }
+
+
+    void* SuiteLibrary::GetSymbol(const char* name) const
+    {
+#if defined(_WIN32)
+        void* result = (void*)GetProcAddress((HMODULE)_handle, name);
+#else
+        void* result = dlsym(_handle, name);
+#endif
+        if (!result)
+            throw std::runtime_error(_path + " does not export " + name + ", is it built with BENCHMARKS_SUITE_LIBRARY?");
+        return result;
+    }
+
+}
@@ -0,0 +1,51 @@
+#ifndef BENCHMARKS_CORE_DETAIL_SUITELIBRARY_HPP
+#define BENCHMARKS_CORE_DETAIL_SUITELIBRARY_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Json.hpp>
+
+#include <string>
+
+
+namespace benchmarks
+{
+
+    // A benchmarks suite built as a shared library with BENCHMARKS_SUITE_LIBRARY, requests have the serve subtask format
+    class SuiteLibrary
+    {
+        using RequestFunc = char* (*)(const char*);
+        using FreeFunc = void (*)(char*);
+
+    private:
+        std::string     _path;
+        void*           _handle;
+        RequestFunc     _request;
+        FreeFunc        _free;
+
+    public:
+        SuiteLibrary(std::string path);
+        ~SuiteLibrary();
+
+        SuiteLibrary(const SuiteLibrary&) = delete;
+        SuiteLibrary& operator = (const SuiteLibrary&) = delete;
+
+        const std::string& GetPath() const { return _path; }
+
+        JsonValue Request(const JsonValue& request) const;
+
+    private:
+        void* GetSymbol(const char* name) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/AllocationCounters.hpp>
+
+#include <benchmarks/alloc_tracker/AllocTracker.hpp>
+
+
+#if defined(__GNUC__)
+#   define BENCHMARKS_ALLOC_TRACKER_HOOK 1
+extern "C" const BenchmarksAllocationCounters* benchmarks_get_thread_allocation_counters() __attribute__((weak));
+#else
+#   define BENCHMARKS_ALLOC_TRACKER_HOOK 0
+#endif
+
+
+namespace benchmarks
+{
+
+    bool AllocationCounters::IsAvailable()
+    {
+#if BENCHMARKS_ALLOC_TRACKER_HOOK
+        return benchmarks_get_thread_allocation_counters != nullptr;
+#else
+        return false;
+#endif
+    }
+
+
+    bool AllocationCounters::Read(Snapshot& snapshot)
+    {
+#if BENCHMARKS_ALLOC_TRACKER_HOOK
+        if (!benchmarks_get_thread_allocation_counters)
+            return false;
+
+        const BenchmarksAllocationCounters* c = benchmarks_get_thread_allocation_counters();
+        snapshot.allocs = c->allocs;
+        snapshot.frees = c->frees;
+        snapshot.bytes = c->bytes;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+}
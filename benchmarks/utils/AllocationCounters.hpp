@@ -0,0 +1,37 @@
+#ifndef BENCHMARKS_CORE_UTILS_ALLOCATIONCOUNTERS_HPP
+#define BENCHMARKS_CORE_UTILS_ALLOCATIONCOUNTERS_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    class AllocationCounters
+    {
+    public:
+        struct Snapshot
+        {
+            int64_t     allocs;
+            int64_t     frees;
+            int64_t     bytes;
+        };
+
+    public:
+        static bool IsAvailable();
+        static bool Read(Snapshot& snapshot);
+    };
+
+}
+
+#endif
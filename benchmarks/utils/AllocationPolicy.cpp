@@ -0,0 +1,350 @@
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/AllocationPolicy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_LINUX_ENVIRONMENT 1
+#   include <errno.h>
+#   include <linux/mempolicy.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#else
+#   define BENCHMARKS_LINUX_ENVIRONMENT 0
+#endif
+#if _WIN32
+#   include <malloc.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        const size_t SmallPageSize = 4096;
+        const size_t HugePageSize = 2 * 1024 * 1024;
+
+        size_t RoundUp(size_t val, size_t alignment)
+        { return (val + alignment - 1) / alignment * alignment; }
+
+        bool IsPowerOfTwo(size_t val)
+        { return val != 0 && (val & (val - 1)) == 0; }
+
+        std::mutex& GetPoliciesMutex()
+        {
+            static std::mutex m;
+            return m;
+        }
+
+        AllocationPolicy& GetDefaultPolicy()
+        {
+            static AllocationPolicy p;
+            return p;
+        }
+
+        std::map<std::string, AllocationPolicy>& GetUsedPoliciesMap()
+        {
+            static std::map<std::string, AllocationPolicy> m;
+            return m;
+        }
+
+        // Calibration allocates the objects over and over again, so the fallbacks are reported once
+        bool WarnOnce(std::atomic<bool>& warned)
+        { return !warned.exchange(true); }
+
+        std::atomic<bool> g_explicitHugePagesWarned(false), g_transparentHugePagesWarned(false), g_numaWarned(false);
+
+        bool IsTransparentHugePagesEnabled()
+        {
+            std::ifstream f("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string s;
+            return std::getline(f, s) && s.find("[never]") == std::string::npos;
+        }
+    }
+
+
+    HugePages ParseHugePages(const std::string& str)
+    {
+        if (str == "none")
+            return HugePages::None;
+        else if (str == "thp")
+            return HugePages::Transparent;
+        else if (str == "explicit")
+            return HugePages::Explicit;
+        else
+            throw std::runtime_error("Unknown huge pages mode: '" + str + "'");
+    }
+
+
+    std::string HugePagesToString(HugePages hugePages)
+    {
+        switch (hugePages)
+        {
+        case HugePages::None: return "none";
+        case HugePages::Transparent: return "thp";
+        case HugePages::Explicit: return "explicit";
+        default: return "unknown";
+        }
+    }
+
+
+    AllocationPolicy AllocationPolicy::Parse(const std::string& str)
+    {
+        AllocationPolicy result;
+        if (str.empty() || str == "default")
+            return result;
+
+        std::stringstream s(str);
+        std::string option;
+        while (std::getline(s, option, ','))
+        {
+            size_t colon = option.find(':');
+            std::string key = option.substr(0, colon);
+            std::string value = colon == std::string::npos ? "" : option.substr(colon + 1);
+
+            if (key == "align")
+            {
+                if (value == "cacheline")
+                    result.alignment = 64;
+                else if (value == "page")
+                    result.alignment = SmallPageSize;
+                else
+                {
+                    char* end = nullptr;
+                    result.alignment = strtoul(value.c_str(), &end, 10);
+                    if (value.empty() || *end != '\0' || !IsPowerOfTwo(result.alignment))
+                        throw std::runtime_error("Alignment must be a power of two, 'cacheline' or 'page': '" + value + "'");
+                }
+            }
+            else if (key == "huge")
+                result.hugePages = ParseHugePages(value);
+            else if (key == "prefault" && value.empty())
+                result.prefault = true;
+            else if (key == "numa-local" && value.empty())
+                result.numaLocal = true;
+            else
+                throw std::runtime_error("Unknown allocation policy option: '" + option + "'");
+        }
+        return result;
+    }
+
+
+    std::string AllocationPolicy::ToString() const
+    {
+        std::string result;
+        if (alignment != 0)
+            result += ",align:" + std::to_string(alignment);
+        if (hugePages != HugePages::None)
+            result += ",huge:" + HugePagesToString(hugePages);
+        if (prefault)
+            result += ",prefault";
+        if (numaLocal)
+            result += ",numa-local";
+        return result.empty() ? "default" : result.substr(1);
+    }
+
+
+    JsonValue AllocationPolicy::ToJson() const
+    {
+        JsonValue result;
+        result["alignment"] = (int64_t)alignment;
+        result["huge_pages"] = HugePagesToString(hugePages);
+        result["prefault"] = prefault;
+        result["numa_local"] = numaLocal;
+        return result;
+    }
+
+
+    AllocationPolicy AllocationPolicy::GetDefault()
+    {
+        std::lock_guard<std::mutex> l(GetPoliciesMutex());
+        return GetDefaultPolicy();
+    }
+
+
+    void AllocationPolicy::SetDefault(const AllocationPolicy& policy)
+    {
+        std::lock_guard<std::mutex> l(GetPoliciesMutex());
+        GetDefaultPolicy() = policy;
+    }
+
+
+    BENCHMARKS_LOGGER(MemoryBlock);
+
+
+    MemoryBlock::MemoryBlock(size_t size, const AllocationPolicy& policy, size_t minAlignment)
+        : _ptr(nullptr), _mapping(nullptr), _mappingSize(0), _actualPolicy(policy)
+    {
+        size = std::max<size_t>(size, 1);
+        size_t alignment = std::max(policy.alignment, minAlignment);
+
+        if (policy.hugePages != HugePages::None || policy.numaLocal || alignment >= SmallPageSize)
+        {
+            if (!Map(size, alignment, policy.hugePages))
+                throw std::runtime_error("Could not map " + std::to_string(size) + " bytes of memory");
+            if (policy.numaLocal && !(_actualPolicy.numaLocal = BindToLocalNumaNode()) && WarnOnce(g_numaWarned))
+                s_logger.Warning() << "Could not bind the memory to the local NUMA node";
+        }
+        else
+        {
+#if _WIN32
+            _ptr = _aligned_malloc(size, alignment);
+#else
+            if (posix_memalign(&_ptr, std::max(alignment, sizeof(void*)), size) != 0)
+                _ptr = nullptr;
+#endif
+            if (!_ptr)
+                throw std::bad_alloc();
+        }
+
+        if (policy.prefault)
+            Prefault(size);
+
+        std::lock_guard<std::mutex> l(GetPoliciesMutex());
+        GetUsedPoliciesMap()[_actualPolicy.ToString()] = _actualPolicy;
+    }
+
+
+    MemoryBlock::~MemoryBlock()
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        if (_mapping)
+        {
+            munmap(_mapping, _mappingSize);
+            return;
+        }
+#endif
+#if _WIN32
+        _aligned_free(_ptr);
+#else
+        free(_ptr);
+#endif
+    }
+
+
+    JsonValue MemoryBlock::GetUsedPolicies()
+    {
+        std::lock_guard<std::mutex> l(GetPoliciesMutex());
+        JsonValue::Array result;
+        for (const auto& p : GetUsedPoliciesMap())
+            result.push_back(p.second.ToJson());
+        return JsonValue(result);
+    }
+
+
+    void MemoryBlock::ResetUsedPolicies()
+    {
+        std::lock_guard<std::mutex> l(GetPoliciesMutex());
+        GetUsedPoliciesMap().clear();
+    }
+
+
+    bool MemoryBlock::Map(size_t size, size_t alignment, HugePages hugePages)
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        if (hugePages == HugePages::Explicit && alignment <= HugePageSize)
+        {
+            _mappingSize = RoundUp(size, HugePageSize);
+            void* p = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                _ptr = _mapping = p;
+                return true;
+            }
+            if (WarnOnce(g_explicitHugePagesWarned))
+                s_logger.Warning() << "Could not map explicit huge pages (" << strerror(errno) << "), falling back to transparent ones";
+            hugePages = HugePages::Transparent;
+        }
+
+        if (hugePages != HugePages::None)
+            alignment = std::max(alignment, HugePageSize);
+
+        size_t rounded_size = RoundUp(size, std::max(alignment, SmallPageSize));
+        _mappingSize = rounded_size + (alignment > SmallPageSize ? alignment : 0);
+        void* p = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            s_logger.Debug() << "mmap failed: " << strerror(errno);
+            return false;
+        }
+        _mapping = p;
+        _ptr = (void*)RoundUp((uintptr_t)p, alignment);
+
+        _actualPolicy.hugePages = HugePages::None;
+        if (hugePages != HugePages::None)
+        {
+            if (madvise(_ptr, rounded_size, MADV_HUGEPAGE) == 0 && IsTransparentHugePagesEnabled())
+                _actualPolicy.hugePages = HugePages::Transparent;
+            else if (WarnOnce(g_transparentHugePagesWarned))
+                s_logger.Warning() << "Transparent huge pages are not available, using the regular ones";
+        }
+        return true;
+#else
+        _actualPolicy.hugePages = HugePages::None;
+#   if _WIN32
+        _ptr = _aligned_malloc(size, alignment);
+#   else
+        if (posix_memalign(&_ptr, std::max(alignment, sizeof(void*)), size) != 0)
+            _ptr = nullptr;
+#   endif
+        return _ptr != nullptr;
+#endif
+    }
+
+
+    bool MemoryBlock::BindToLocalNumaNode()
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+        {
+            s_logger.Debug() << "getcpu failed: " << strerror(errno);
+            return false;
+        }
+
+        const int bits_per_word = 8 * sizeof(unsigned long);
+        unsigned long node_mask[1024 / bits_per_word] = { };
+        if (node >= 1024)
+            return false;
+        node_mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+        if (syscall(SYS_mbind, _mapping, _mappingSize, MPOL_BIND, node_mask, 1024, 0) != 0)
+        {
+            s_logger.Debug() << "mbind failed: " << strerror(errno);
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    void MemoryBlock::Prefault(size_t size)
+    {
+        volatile char* p = (volatile char*)_ptr;
+        for (size_t i = 0; i < size; i += SmallPageSize)
+            p[i] = 0;
+        p[size - 1] = 0;
+    }
+
+}
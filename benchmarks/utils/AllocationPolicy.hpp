@@ -0,0 +1,100 @@
+#ifndef BENCHMARKS_CORE_UTILS_ALLOCATIONPOLICY_HPP
+#define BENCHMARKS_CORE_UTILS_ALLOCATIONPOLICY_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Json.hpp>
+#include <benchmarks/utils/Logger.hpp>
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    enum class HugePages
+    {
+        None,
+        Transparent,    // madvise(MADV_HUGEPAGE), the kernel may still back the memory with small pages
+        Explicit        // MAP_HUGETLB, needs preallocated huge pages (vm.nr_hugepages)
+    };
+
+    HugePages ParseHugePages(const std::string& str);
+    std::string HugePagesToString(HugePages hugePages);
+
+
+    // How the memory for the benchmark objects is allocated, parsed from comma-separated options,
+    // e.g. "align:64", "huge:thp,prefault" or "align:4096,numa-local"
+    struct AllocationPolicy
+    {
+        size_t      alignment;  // 0 for the default alignment of the type
+        HugePages   hugePages;
+        bool        prefault;
+        bool        numaLocal;  // Place the memory on the NUMA node of the allocating thread
+
+        AllocationPolicy() : alignment(0), hugePages(HugePages::None), prefault(false), numaLocal(false) { }
+
+        static AllocationPolicy Parse(const std::string& str);
+
+        std::string ToString() const;
+        JsonValue ToJson() const;
+
+        bool operator == (const AllocationPolicy& other) const
+        { return alignment == other.alignment && hugePages == other.hugePages && prefault == other.prefault && numaLocal == other.numaLocal; }
+
+        bool operator != (const AllocationPolicy& other) const
+        { return !(*this == other); }
+
+        // The policy of the StorageArray objects that do not specify one
+        static AllocationPolicy GetDefault();
+        static void SetDefault(const AllocationPolicy& policy);
+    };
+
+
+    // A memory block allocated according to a policy. The actual policy may be weaker than the requested one
+    // (e.g. no huge pages reserved in the system), the actual policies of all the blocks are recorded for the results.
+    class MemoryBlock
+    {
+    private:
+        static NamedLogger      s_logger;
+
+        void*                   _ptr;
+        void*                   _mapping;
+        size_t                  _mappingSize;
+        AllocationPolicy        _actualPolicy;
+
+    public:
+        MemoryBlock(size_t size, const AllocationPolicy& policy, size_t minAlignment = 1);
+        ~MemoryBlock();
+
+        MemoryBlock(const MemoryBlock&) = delete;
+        MemoryBlock& operator = (const MemoryBlock&) = delete;
+
+        void* Get() const { return _ptr; }
+        const AllocationPolicy& GetActualPolicy() const { return _actualPolicy; }
+
+        // Distinct actual policies of the blocks allocated since the last reset
+        static JsonValue GetUsedPolicies();
+        static void ResetUsedPolicies();
+
+    private:
+        bool Map(size_t size, size_t alignment, HugePages hugePages);
+        bool BindToLocalNumaNode();
+        void Prefault(size_t size);
+    };
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/AsyncOperations.hpp>
+
+
+namespace benchmarks
+{
+
+    AsyncOperations::AsyncOperations(int64_t highestTrackableLatencyNs)
+        : _layout(highestTrackableLatencyNs), _counts(new std::atomic<int64_t>[_layout.GetIndicesCount()]), _started(0), _completed(0)
+    {
+        for (size_t i = 0; i < _layout.GetIndicesCount(); ++i)
+            _counts[i].store(0, std::memory_order_relaxed);
+    }
+
+
+    HdrHistogram AsyncOperations::GetLatencies() const
+    {
+        HdrHistogram result = _layout;
+        for (size_t i = 0; i < _layout.GetIndicesCount(); ++i)
+        {
+            int64_t count = _counts[i].load(std::memory_order_acquire);
+            if (count != 0)
+                result.Record(_layout.GetHighestEquivalentValue(i), count);
+        }
+        return result;
+    }
+
+}
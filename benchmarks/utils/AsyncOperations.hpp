@@ -0,0 +1,68 @@
+#ifndef BENCHMARKS_CORE_UTILS_ASYNCOPERATIONS_HPP
+#define BENCHMARKS_CORE_UTILS_ASYNCOPERATIONS_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/HdrHistogram.hpp>
+#include <benchmarks/utils/TscClock.hpp>
+
+#include <atomic>
+#include <memory>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    // Start and completion stamps of the operations that finish after the submitting call returns.
+    // Start and Complete may be called from any thread, the latencies are counted without locks.
+    class AsyncOperations
+    {
+    public:
+        using Token = int64_t;
+
+    private:
+        HdrHistogram                                _layout;
+        std::unique_ptr<std::atomic<int64_t>[]>     _counts;
+        std::atomic<int64_t>                        _started;
+        std::atomic<int64_t>                        _completed;
+
+    public:
+        explicit AsyncOperations(int64_t highestTrackableLatencyNs);
+
+        AsyncOperations(const AsyncOperations&) = delete;
+        AsyncOperations& operator = (const AsyncOperations&) = delete;
+
+        Token Start()
+        {
+            _started.fetch_add(1, std::memory_order_relaxed);
+            return TscClock::now().time_since_epoch().count();
+        }
+
+        void Complete(Token token)
+        {
+            int64_t latency = TscClock::now().time_since_epoch().count() - token;
+            _counts[_layout.GetIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+            _completed.fetch_add(1, std::memory_order_release);
+        }
+
+        int64_t GetStartedCount() const { return _started.load(std::memory_order_relaxed); }
+        int64_t GetCompletedCount() const { return _completed.load(std::memory_order_acquire); }
+        bool IsIdle() const { return GetCompletedCount() >= GetStartedCount(); }
+
+        HdrHistogram GetLatencies() const;
+    };
+
+}
+
+#endif
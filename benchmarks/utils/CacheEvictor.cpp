@@ -0,0 +1,273 @@
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/CacheEvictor.hpp>
+
+#include <benchmarks/utils/DoNotOptimize.hpp>
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_LINUX_ENVIRONMENT 1
+#   include <sys/mman.h>
+#else
+#   define BENCHMARKS_LINUX_ENVIRONMENT 0
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#   define BENCHMARKS_X86 1
+#   include <immintrin.h>
+#   if defined(__GNUC__)
+#       include <cpuid.h>
+#   endif
+#else
+#   define BENCHMARKS_X86 0
+#endif
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        const size_t CacheLineSize = 64;
+        const size_t PageSize = 4096;
+        const size_t TlbSweepPages = 16384;
+        const size_t DefaultLastLevelCacheSize = 32 * 1024 * 1024;
+
+        const char* GetSweepBuffer(size_t size)
+        {
+            static const std::vector<char> buffer(size);
+            return buffer.data();
+        }
+
+        class TlbBuffer
+        {
+        private:
+            char*               _ptr;
+            std::vector<char>   _fallback;
+
+        public:
+            TlbBuffer() : _ptr(nullptr)
+            {
+                size_t size = TlbSweepPages * PageSize;
+#if BENCHMARKS_LINUX_ENVIRONMENT
+                void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p != MAP_FAILED)
+                {
+                    _ptr = (char*)p;
+                    // Huge pages would cover the whole buffer with a few TLB entries
+                    madvise(_ptr, size, MADV_NOHUGEPAGE);
+                    for (size_t i = 0; i < TlbSweepPages; ++i)
+                        _ptr[i * PageSize] = 0;
+                    return;
+                }
+#endif
+                _fallback.resize(size);
+            }
+
+            ~TlbBuffer()
+            {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+                if (_ptr)
+                    munmap(_ptr, TlbSweepPages * PageSize);
+#endif
+            }
+
+            const char* Get() const { return _ptr ? _ptr : _fallback.data(); }
+        };
+
+        const char* GetTlbBuffer()
+        {
+            static const TlbBuffer buffer;
+            return buffer.Get();
+        }
+
+#if BENCHMARKS_X86
+#   if defined(__GNUC__)
+        bool IsClflushoptSupported()
+        {
+            unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+            return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 23));
+        }
+
+        __attribute__((target("clflushopt"))) void FlushLinesOpt(const char* begin, const char* end)
+        {
+            for (const char* p = begin; p < end; p += CacheLineSize)
+                _mm_clflushopt((void*)p);
+        }
+#   else
+        bool IsClflushoptSupported()
+        { return false; }
+
+        void FlushLinesOpt(const char*, const char*)
+        { }
+#   endif
+
+        void FlushLines(const char* begin, const char* end)
+        {
+            static const bool clflushopt = IsClflushoptSupported();
+            begin = (const char*)((uintptr_t)begin & ~(uintptr_t)(CacheLineSize - 1));
+            if (clflushopt)
+                FlushLinesOpt(begin, end);
+            else
+                for (const char* p = begin; p < end; p += CacheLineSize)
+                    _mm_clflush(p);
+        }
+#endif
+    }
+
+
+    CacheState ParseCacheState(const std::string& str)
+    {
+        if (str == "warm")
+            return CacheState::Warm;
+        else if (str == "cold-data")
+            return CacheState::ColdData;
+        else if (str == "cold-tlb")
+            return CacheState::ColdTlb;
+        else if (str == "cold")
+            return CacheState::Cold;
+        else
+            throw std::runtime_error("Unknown cache state: '" + str + "'");
+    }
+
+
+    std::string CacheStateToString(CacheState state)
+    {
+        switch (state)
+        {
+        case CacheState::Warm: return "warm";
+        case CacheState::ColdData: return "cold-data";
+        case CacheState::ColdTlb: return "cold-tlb";
+        case CacheState::Cold: return "cold";
+        default: return "unknown";
+        }
+    }
+
+
+    std::istream& operator >> (std::istream& s, CacheState& state)
+    {
+        std::string str;
+        s >> str;
+        state = ParseCacheState(str);
+        return s;
+    }
+
+
+    BENCHMARKS_LOGGER(CacheEvictor);
+
+
+    CacheEvictor::CacheEvictor(CacheState state)
+        : _state(state)
+    {
+        // Allocating the buffers on the first eviction would put the page faults into the measurements
+        if (_state == CacheState::ColdData || _state == CacheState::Cold)
+            GetSweepBuffer(2 * GetLastLevelCacheSize());
+        if (_state == CacheState::ColdTlb || _state == CacheState::Cold)
+            GetTlbBuffer();
+    }
+
+
+    void CacheEvictor::AddRange(const void* ptr, size_t size)
+    { _ranges.push_back(std::make_pair((const char*)ptr, size)); }
+
+
+    void CacheEvictor::Evict() const
+    {
+        if (_state == CacheState::ColdData || _state == CacheState::Cold)
+        {
+            if (!FlushRanges())
+                SweepDataCache();
+        }
+        if (_state == CacheState::ColdTlb || _state == CacheState::Cold)
+            SweepTlb();
+    }
+
+
+    size_t CacheEvictor::GetLastLevelCacheSize()
+    {
+        static const size_t result = []
+            {
+                int max_level = 0;
+                size_t size = 0;
+                for (int i = 0; i < 16; ++i)
+                {
+                    std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+                    std::ifstream level_file(dir + "level"), size_file(dir + "size");
+                    int level = 0;
+                    std::string size_str;
+                    if (!(level_file >> level) || !(size_file >> size_str) || level < max_level)
+                        continue;
+
+                    size_t val = strtoul(size_str.c_str(), nullptr, 10);
+                    switch (size_str.back())
+                    {
+                    case 'K': val *= 1024; break;
+                    case 'M': val *= 1024 * 1024; break;
+                    }
+                    max_level = level;
+                    size = val;
+                }
+
+                if (size == 0)
+                {
+                    s_logger.Info() << "Could not detect the last level cache size, assuming " << DefaultLastLevelCacheSize / (1024 * 1024) << " MB";
+                    return DefaultLastLevelCacheSize;
+                }
+                return size;
+            }();
+        return result;
+    }
+
+
+    bool CacheEvictor::FlushRanges() const
+    {
+#if BENCHMARKS_X86
+        if (_ranges.empty())
+            return false;
+        for (const auto& r : _ranges)
+            FlushLines(r.first, r.first + r.second);
+        _mm_mfence();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    void CacheEvictor::SweepDataCache()
+    {
+        size_t size = 2 * GetLastLevelCacheSize();
+        // Reading, so the evicted lines of the buffer are clean and there are no write-backs in the measured operation
+        const volatile char* p = (const volatile char*)GetSweepBuffer(size);
+        char sum = 0;
+        for (size_t i = 0; i < size; i += CacheLineSize)
+            sum += p[i];
+        DoNotOptimize(sum);
+    }
+
+
+    void CacheEvictor::SweepTlb()
+    {
+        // The same offset in every page, so the sweep only competes for the few cache sets that offset maps to
+        // instead of reading a megabyte of distinct lines through the data caches
+        const volatile char* p = (const volatile char*)GetTlbBuffer();
+        char sum = 0;
+        for (size_t i = 0; i < TlbSweepPages; ++i)
+            sum += p[i * PageSize];
+        DoNotOptimize(sum);
+    }
+
+}
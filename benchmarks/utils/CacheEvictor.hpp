@@ -0,0 +1,72 @@
+#ifndef BENCHMARKS_CORE_UTILS_CACHEEVICTOR_HPP
+#define BENCHMARKS_CORE_UTILS_CACHEEVICTOR_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Logger.hpp>
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+
+namespace benchmarks
+{
+
+    enum class CacheState
+    {
+        Warm,
+        ColdData,   // The data caches are evicted, the fixture memory has to be fetched from RAM
+        ColdTlb,    // The TLB is evicted, the data caches only lose the lines of the sets the sweep maps to
+        Cold        // Both
+    };
+
+    CacheState ParseCacheState(const std::string& str);
+    std::string CacheStateToString(CacheState state);
+
+    std::istream& operator >> (std::istream& s, CacheState& state);
+
+
+    // Brings the caches to the requested state before an operation. The data caches are evicted either by flushing
+    // the registered fixture ranges (clflushopt/clflush on x86) or, when there are none, by reading a buffer twice the
+    // size of the last level cache. The TLB is evicted by touching the first line of each of the pages of a 64 MB buffer.
+    class CacheEvictor
+    {
+    private:
+        static NamedLogger      s_logger;
+
+        CacheState                                  _state;
+        std::vector<std::pair<const char*, size_t>> _ranges;
+
+    public:
+        CacheEvictor(CacheState state);
+
+        CacheState GetState() const { return _state; }
+
+        void AddRange(const void* ptr, size_t size);
+
+        void Evict() const;
+
+        static size_t GetLastLevelCacheSize();
+
+    private:
+        bool FlushRanges() const;
+        static void SweepDataCache();
+        static void SweepTlb();
+    };
+
+}
+
+#endif
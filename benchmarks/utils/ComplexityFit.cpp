@@ -0,0 +1,102 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/ComplexityFit.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        double ComplexityFunction(Complexity complexity, double n)
+        {
+            switch (complexity)
+            {
+            case Complexity::Constant: return 1;
+            case Complexity::Logarithmic: return std::log2(n);
+            case Complexity::Linear: return n;
+            case Complexity::Linearithmic: return n * std::log2(n);
+            case Complexity::Quadratic: return n * n;
+            default: throw std::runtime_error("Unknown complexity");
+            }
+        }
+    }
+
+
+    std::string ComplexityToString(Complexity complexity)
+    {
+        switch (complexity)
+        {
+        case Complexity::Constant: return "O(1)";
+        case Complexity::Logarithmic: return "O(log n)";
+        case Complexity::Linear: return "O(n)";
+        case Complexity::Linearithmic: return "O(n log n)";
+        case Complexity::Quadratic: return "O(n^2)";
+        default: return "unknown";
+        }
+    }
+
+
+    ComplexityFitResult FitComplexity(Complexity complexity, const std::vector<double>& n, const std::vector<double>& values)
+    {
+        if (n.size() != values.size() || n.empty())
+            throw std::runtime_error("Invalid data for the complexity fit");
+
+        double sum_fv = 0, sum_ff = 0, sum_v = 0;
+        for (size_t i = 0; i < n.size(); ++i)
+        {
+            if (n[i] <= 0)
+                throw std::runtime_error("Complexity fit requires positive parameter values");
+            double f = ComplexityFunction(complexity, n[i]);
+            sum_fv += f * values[i];
+            sum_ff += f * f;
+            sum_v += values[i];
+        }
+
+        double coefficient = sum_ff > 0 ? sum_fv / sum_ff : 0;
+
+        double sum_sq_residuals = 0;
+        for (size_t i = 0; i < n.size(); ++i)
+        {
+            double residual = values[i] - coefficient * ComplexityFunction(complexity, n[i]);
+            sum_sq_residuals += residual * residual;
+        }
+
+        double mean = sum_v / values.size();
+        double rms = std::sqrt(sum_sq_residuals / values.size());
+        return ComplexityFitResult(complexity, coefficient, mean != 0 ? rms / std::fabs(mean) : rms);
+    }
+
+
+    std::vector<ComplexityFitResult> FitAllComplexities(const std::vector<double>& n, const std::vector<double>& values)
+    {
+        std::vector<ComplexityFitResult> result;
+        for (auto c : { Complexity::Constant, Complexity::Logarithmic, Complexity::Linear, Complexity::Linearithmic, Complexity::Quadratic })
+            result.push_back(FitComplexity(c, n, values));
+        return result;
+    }
+
+
+    ComplexityFitResult FindBestComplexityFit(const std::vector<ComplexityFitResult>& fits)
+    {
+        if (fits.empty())
+            throw std::runtime_error("No complexity fits");
+
+        auto best = fits.front();
+        for (auto&& fit : fits)
+            if (fit.rms < best.rms)
+                best = fit;
+        return best;
+    }
+
+}
@@ -0,0 +1,52 @@
+#ifndef BENCHMARKS_CORE_UTILS_COMPLEXITYFIT_HPP
+#define BENCHMARKS_CORE_UTILS_COMPLEXITYFIT_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <string>
+#include <vector>
+
+
+namespace benchmarks
+{
+
+    enum class Complexity
+    {
+        Constant,
+        Logarithmic,
+        Linear,
+        Linearithmic,
+        Quadratic
+    };
+
+    std::string ComplexityToString(Complexity complexity);
+
+
+    struct ComplexityFitResult
+    {
+        Complexity      complexity;
+        double          coefficient;
+        double          rms;            // root mean square of the residuals relative to the mean of the measured values
+
+        ComplexityFitResult(Complexity complexity, double coefficient, double rms)
+            : complexity(complexity), coefficient(coefficient), rms(rms)
+        { }
+    };
+
+
+    // Least squares fit of values = coefficient * f(n), n values must be positive
+    ComplexityFitResult FitComplexity(Complexity complexity, const std::vector<double>& n, const std::vector<double>& values);
+    std::vector<ComplexityFitResult> FitAllComplexities(const std::vector<double>& n, const std::vector<double>& values);
+    ComplexityFitResult FindBestComplexityFit(const std::vector<ComplexityFitResult>& fits);
+
+}
+
+#endif
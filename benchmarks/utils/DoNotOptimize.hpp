@@ -0,0 +1,86 @@
+#ifndef BENCHMARKS_CORE_UTILS_DONOTOPTIMIZE_HPP
+#define BENCHMARKS_CORE_UTILS_DONOTOPTIMIZE_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    namespace detail
+    {
+        // Defined in a separate translation unit, so the compiler has to assume the pointed value is read
+        void UseCharPointer(const volatile char* p);
+    }
+
+
+#if defined(__GNUC__)
+
+    // Forces the value to be computed and held in a register or in memory at this point
+    template < typename T_ >
+    inline __attribute__((always_inline)) void DoNotOptimize(const T_& value)
+    { asm volatile ("" : : "r,m"(value) : "memory"); }
+
+    template < typename T_ >
+    inline __attribute__((always_inline)) void DoNotOptimize(T_& value)
+    {
+#   if defined(__clang__)
+        asm volatile ("" : "+r,m"(value) : : "memory");
+#   else
+        asm volatile ("" : "+m,r"(value) : : "memory");
+#   endif
+    }
+
+    // Makes all the writes to memory observable, so stores that are never read again are not removed
+    inline __attribute__((always_inline)) void ClobberMemory()
+    { asm volatile ("" : : : "memory"); }
+
+    // Lets the address of the object escape, so its contents have to be kept up to date
+    template < typename T_ >
+    inline __attribute__((always_inline)) void KeepAlive(const T_& object)
+    { asm volatile ("" : : "g"(&object) : "memory"); }
+
+#else
+
+    template < typename T_ >
+    inline void DoNotOptimize(const T_& value)
+    {
+        detail::UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+#   if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#   endif
+    }
+
+    inline void ClobberMemory()
+    {
+#   if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#   else
+        detail::UseCharPointer(nullptr);
+#   endif
+    }
+
+    template < typename T_ >
+    inline void KeepAlive(const T_& object)
+    {
+        detail::UseCharPointer(&reinterpret_cast<const volatile char&>(object));
+        ClobberMemory();
+    }
+
+#endif
+
+}
+
+#endif
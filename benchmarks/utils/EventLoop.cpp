@@ -0,0 +1,60 @@
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/EventLoop.hpp>
+
+#include <benchmarks/utils/SpinBarrier.hpp>
+
+#include <thread>
+
+
+namespace benchmarks
+{
+
+    void EventLoop::Post(Task task)
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        _tasks.push_back(std::move(task));
+        _hasTasks.store(true, std::memory_order_release);
+    }
+
+
+    size_t EventLoop::RunPending()
+    {
+        if (!_hasTasks.load(std::memory_order_acquire))
+            return 0;
+
+        _runningTasks.clear();
+        {
+            std::lock_guard<std::mutex> l(_mutex);
+            _runningTasks.swap(_tasks);
+            _hasTasks.store(false, std::memory_order_relaxed);
+        }
+
+        for (auto&& task : _runningTasks)
+            task();
+        return _runningTasks.size();
+    }
+
+
+    void EventLoop::RunUntil(const std::function<bool()>& done)
+    {
+        for (int idle_spins = 0; !done(); )
+        {
+            if (RunPending() != 0)
+                idle_spins = 0;
+            else if (++idle_spins < MaxIdleSpinsBeforeYield)
+                CpuRelax();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+}
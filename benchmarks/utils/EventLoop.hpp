@@ -0,0 +1,93 @@
+#ifndef BENCHMARKS_CORE_UTILS_EVENTLOOP_HPP
+#define BENCHMARKS_CORE_UTILS_EVENTLOOP_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#   include <coroutine>
+#   define BENCHMARKS_HAS_COROUTINES 1
+#endif
+
+
+namespace benchmarks
+{
+
+    // Single-threaded loop for callback and coroutine based code. Tasks may be posted from any thread,
+    // they are executed by the thread that runs the loop.
+    class EventLoop
+    {
+        using Task = std::function<void()>;
+
+        static const int MaxIdleSpinsBeforeYield = 4096;
+
+    private:
+        std::mutex          _mutex;
+        std::deque<Task>    _tasks;
+        std::atomic<bool>   _hasTasks;
+        std::deque<Task>    _runningTasks; // swapped with _tasks, so that the loop thread reuses its memory
+
+    public:
+        EventLoop() : _hasTasks(false) { }
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator = (const EventLoop&) = delete;
+
+        void Post(Task task);
+
+        // Returns the number of executed tasks, the tasks posted by them are left for the next call
+        size_t RunPending();
+        void RunUntil(const std::function<bool()>& done);
+
+#if defined(BENCHMARKS_HAS_COROUTINES)
+        class ScheduleAwaiter
+        {
+        private:
+            EventLoop&      _loop;
+
+        public:
+            explicit ScheduleAwaiter(EventLoop& loop) : _loop(loop) { }
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { _loop.Post([handle] { handle.resume(); }); }
+            void await_resume() const noexcept { }
+        };
+
+        // co_await loop.Schedule() resumes the coroutine from the loop
+        ScheduleAwaiter Schedule() { return ScheduleAwaiter(*this); }
+#endif
+    };
+
+
+#if defined(BENCHMARKS_HAS_COROUTINES)
+    // Coroutine that starts immediately and destroys itself on completion, the results are reported through AsyncOperations
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            DetachedTask get_return_object() noexcept { return DetachedTask(); }
+            std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+            std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+            void return_void() const noexcept { }
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+#endif
+
+}
+
+#endif
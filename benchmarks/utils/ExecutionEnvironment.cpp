@@ -0,0 +1,266 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/ExecutionEnvironment.hpp>
+
+#include <benchmarks/utils/Memory.hpp>
+#include <benchmarks/utils/ThreadPriority.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_LINUX_ENVIRONMENT 1
+#   include <errno.h>
+#   include <linux/mempolicy.h>
+#   include <pthread.h>
+#   include <sched.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#else
+#   define BENCHMARKS_LINUX_ENVIRONMENT 0
+#endif
+#if defined(__GLIBC__)
+#   include <malloc.h>
+#endif
+#if _WIN32
+#   include <windows.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    BENCHMARKS_LOGGER(ExecutionEnvironment);
+
+    std::vector<int> ExecutionEnvironment::s_workerCpus;
+
+
+    ExecutionEnvironment::ExecutionEnvironment(ExecutionEnvironmentOptions options)
+        : _options(std::move(options)), _realtimePriority(false), _affinity(false), _numaBound(false), _memoryLocked(false), _prefaultedBytes(0), _mallocMmapDisabled(false)
+    { }
+
+
+    void ExecutionEnvironment::Apply()
+    {
+        if (_options.numaNode >= 0 && !(_numaBound = BindMemoryToNumaNode(_options.numaNode)))
+            s_logger.Warning() << "Could not bind memory to NUMA node " << _options.numaNode;
+
+        if (!_options.cpus.empty())
+        {
+            // The benchmark thread stays on the first CPU, worker threads are spread over the whole set
+            if (!(_affinity = SetThreadAffinity(std::vector<int>(1, _options.cpus.front()))))
+                s_logger.Warning() << "Could not set the CPU affinity";
+            else
+                s_workerCpus = _options.cpus;
+        }
+
+        if (_options.realtimePriority && !(_realtimePriority = SetMaxThreadPriority()))
+            s_logger.Warning() << "Could not set the realtime thread priority, the results may be noisy";
+
+        if (_options.lockMemory && !(_memoryLocked = LockMemory()))
+            s_logger.Warning() << "Could not lock the process memory";
+
+        if (_options.disableMallocMmap && !(_mallocMmapDisabled = DisableMallocMmap()))
+            s_logger.Warning() << "Could not disable the mmap-based allocations of malloc";
+
+        if (_options.prefaultBytes > 0)
+        {
+            if ((_prefaultedBytes = PrefaultMemory(_options.prefaultBytes)) == 0)
+                s_logger.Warning() << "Could not prefault " << _options.prefaultBytes << " bytes";
+            else
+                s_logger.Info() << "Prefaulted " << _prefaultedBytes << " bytes, RSS based memory measurements will not see the reused pages";
+        }
+    }
+
+
+    JsonValue ExecutionEnvironment::ToJson() const
+    {
+        JsonValue result;
+        result["realtime_priority"] = _realtimePriority;
+        result["cpus"] = JsonValue::Array();
+        for (int cpu : _options.cpus)
+            result["cpus"].Append(cpu);
+        result["affinity"] = _affinity;
+        result["numa_node"] = _options.numaNode;
+        result["numa_bound"] = _numaBound;
+        result["memory_locked"] = _memoryLocked;
+        result["prefaulted_bytes"] = _prefaultedBytes;
+        result["malloc_mmap_disabled"] = _mallocMmapDisabled;
+        return result;
+    }
+
+
+    int ExecutionEnvironment::GetMaxCpus()
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        return CPU_SETSIZE;
+#elif _WIN32
+        return 8 * sizeof(DWORD_PTR);
+#else
+        return 1024;
+#endif
+    }
+
+
+    std::vector<int> ExecutionEnvironment::ParseCpuList(const std::string& str)
+    {
+        auto parse_cpu = [&](const std::string& cpu_str)
+            {
+                char* end = nullptr;
+                long cpu = strtol(cpu_str.c_str(), &end, 10);
+                if (cpu_str.empty() || *end != '\0' || cpu < 0 || cpu >= GetMaxCpus())
+                    throw std::runtime_error("Invalid CPU list: '" + str + "', expected comma-separated CPU ids or ranges from 0 to " + std::to_string(GetMaxCpus() - 1));
+                return (int)cpu;
+            };
+
+        std::vector<int> result;
+        std::stringstream s(str);
+        std::string range;
+        while (std::getline(s, range, ','))
+        {
+            auto dash_pos = range.find('-');
+            int first = parse_cpu(range.substr(0, dash_pos));
+            int last = (dash_pos == std::string::npos) ? first : parse_cpu(range.substr(dash_pos + 1));
+            if (last < first)
+                throw std::runtime_error("Invalid CPU range '" + range + "' in the CPU list: '" + str + "'");
+            for (int cpu = first; cpu <= last; ++cpu)
+                result.push_back(cpu);
+        }
+        if (result.empty() || str.back() == ',')
+            throw std::runtime_error("Invalid CPU list: '" + str + "'");
+        return result;
+    }
+
+
+    void ExecutionEnvironment::PinWorkerThread(int index)
+    {
+        if (s_workerCpus.empty())
+            return;
+
+        int cpu = s_workerCpus[index % s_workerCpus.size()];
+        if (!SetThreadAffinity(std::vector<int>(1, cpu)))
+            s_logger.Warning() << "Could not pin worker thread " << index << " to CPU " << cpu;
+    }
+
+
+    std::vector<int> ExecutionEnvironment::GetWorkerCpus()
+    { return s_workerCpus; }
+
+
+    void ExecutionEnvironment::SetWorkerCpus(std::vector<int> cpus)
+    { s_workerCpus = std::move(cpus); }
+
+
+    bool ExecutionEnvironment::SetThreadAffinity(const std::vector<int>& cpus)
+    {
+        for (int cpu : cpus)
+            if (cpu < 0 || cpu >= GetMaxCpus())
+                return false;
+
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu : cpus)
+            CPU_SET(cpu, &cpu_set);
+        int res = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (res != 0)
+            s_logger.Debug() << "pthread_setaffinity_np failed: " << strerror(res);
+        return res == 0;
+#elif _WIN32
+        DWORD_PTR mask = 0;
+        for (int cpu : cpus)
+            mask |= DWORD_PTR(1) << cpu;
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+        return false;
+#endif
+    }
+
+
+    bool ExecutionEnvironment::BindMemoryToNumaNode(int node)
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        const int bits_per_word = 8 * sizeof(unsigned long);
+        unsigned long node_mask[1024 / bits_per_word] = { };
+        if (node >= 1024)
+            return false;
+        node_mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+        if (syscall(SYS_set_mempolicy, MPOL_BIND, node_mask, 1024) != 0)
+        {
+            s_logger.Debug() << "set_mempolicy failed: " << strerror(errno);
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    bool ExecutionEnvironment::LockMemory()
+    {
+#if BENCHMARKS_LINUX_ENVIRONMENT
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        {
+            s_logger.Debug() << "mlockall failed: " << strerror(errno);
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    int64_t ExecutionEnvironment::PrefaultMemory(int64_t bytes)
+    {
+#if defined(__GLIBC__)
+        // Keep the freed pages in the heap, so that the benchmarks reuse them instead of faulting in new ones
+        mallopt(M_TRIM_THRESHOLD, 0x7FFFFFFF);
+        Memory::SetReleaseFreeMemoryEnabled(false);
+
+        // The chunks are below the mmap threshold, so they come from the heap and stay there after being freed
+        const int64_t chunk_size = 64 * 1024;
+        const int64_t page_size = 4096;
+        std::vector<char*> chunks;
+        int64_t result = 0;
+        for (; result < bytes; result += chunk_size)
+        {
+            char* p = (char*)malloc(chunk_size);
+            if (!p)
+                break;
+            for (int64_t i = 0; i < chunk_size; i += page_size)
+                ((volatile char*)p)[i] = 0;
+            chunks.push_back(p);
+        }
+        for (char* p : chunks)
+            free(p);
+        return result;
+#else
+        return 0;
+#endif
+    }
+
+
+    bool ExecutionEnvironment::DisableMallocMmap()
+    {
+#if defined(__GLIBC__)
+        // Large blocks come from the heap as well, so they reuse its pages instead of mapping new ones each time
+        return mallopt(M_MMAP_MAX, 0) == 1;
+#else
+        return false;
+#endif
+    }
+
+}
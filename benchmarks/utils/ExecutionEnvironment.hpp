@@ -0,0 +1,79 @@
+#ifndef BENCHMARKS_CORE_UTILS_EXECUTIONENVIRONMENT_HPP
+#define BENCHMARKS_CORE_UTILS_EXECUTIONENVIRONMENT_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Json.hpp>
+#include <benchmarks/utils/Logger.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    struct ExecutionEnvironmentOptions
+    {
+        std::vector<int>    cpus;
+        int                 numaNode;
+        bool                lockMemory;
+        int64_t             prefaultBytes;
+        bool                disableMallocMmap;
+        bool                realtimePriority;
+
+        ExecutionEnvironmentOptions()
+            : numaNode(-1), lockMemory(false), prefaultBytes(0), disableMallocMmap(false), realtimePriority(true)
+        { }
+    };
+
+
+    class ExecutionEnvironment
+    {
+    private:
+        static NamedLogger              s_logger;
+        static std::vector<int>         s_workerCpus;
+
+        ExecutionEnvironmentOptions     _options;
+        bool                            _realtimePriority;
+        bool                            _affinity;
+        bool                            _numaBound;
+        bool                            _memoryLocked;
+        int64_t                         _prefaultedBytes;
+        bool                            _mallocMmapDisabled;
+
+    public:
+        ExecutionEnvironment(ExecutionEnvironmentOptions options);
+
+        void Apply();
+        JsonValue ToJson() const;
+
+        static int GetMaxCpus();
+        static std::vector<int> ParseCpuList(const std::string& str);
+        static void PinWorkerThread(int index);
+
+        // A suite library loaded by the interleave subtask has its own copy of these, the host passes them along with the requests
+        static std::vector<int> GetWorkerCpus();
+        static void SetWorkerCpus(std::vector<int> cpus);
+
+    private:
+        static bool SetThreadAffinity(const std::vector<int>& cpus);
+        static bool BindMemoryToNumaNode(int node);
+        static bool LockMemory();
+        static int64_t PrefaultMemory(int64_t bytes);
+        static bool DisableMallocMmap();
+    };
+
+}
+
+#endif
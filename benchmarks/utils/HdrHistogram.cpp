@@ -0,0 +1,92 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/HdrHistogram.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+
+namespace benchmarks
+{
+
+    HdrHistogram::HdrHistogram(int64_t highestTrackableValue, int significantDigits)
+        : _highestTrackableValue(highestTrackableValue), _totalCount(0), _min(std::numeric_limits<int64_t>::max()), _max(0), _sum(0)
+    {
+        if (significantDigits < 1 || significantDigits > 5)
+            throw std::runtime_error("HdrHistogram supports from 1 to 5 significant digits!");
+        if (highestTrackableValue < 2)
+            throw std::runtime_error("Invalid HdrHistogram highest trackable value!");
+
+        int64_t largest_value_with_single_unit_resolution = 2 * (int64_t)std::pow(10, significantDigits);
+        int sub_bucket_count_magnitude = (int)std::ceil(std::log2((double)largest_value_with_single_unit_resolution));
+        _subBucketHalfCountMagnitude = sub_bucket_count_magnitude - 1;
+        _subBucketCount = int64_t(1) << sub_bucket_count_magnitude;
+        _subBucketHalfCount = _subBucketCount / 2;
+        _subBucketMask = _subBucketCount - 1;
+
+        _counts.assign(GetIndex(_highestTrackableValue) + 1, 0);
+    }
+
+
+    void HdrHistogram::Add(const HdrHistogram& other)
+    {
+        if (other._counts.size() != _counts.size() || other._subBucketCount != _subBucketCount)
+            throw std::runtime_error("Incompatible HdrHistogram layouts!");
+
+        for (size_t i = 0; i < _counts.size(); ++i)
+            _counts[i] += other._counts[i];
+        _totalCount += other._totalCount;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+        _sum += other._sum;
+    }
+
+
+    int64_t HdrHistogram::GetValueAtPercentile(double percentile) const
+    {
+        if (_totalCount == 0)
+            return 0;
+
+        int64_t count_at_percentile = std::max<int64_t>(1, (int64_t)(std::min(percentile, 100.0) / 100 * _totalCount + 0.5));
+        int64_t total = 0;
+        for (size_t i = 0; i < _counts.size(); ++i)
+        {
+            total += _counts[i];
+            if (total >= count_at_percentile)
+                return std::min(GetHighestEquivalentValue(i), _max);
+        }
+        return _max;
+    }
+
+
+    std::vector<HdrHistogram::Bucket> HdrHistogram::GetBuckets() const
+    {
+        std::vector<Bucket> result;
+        for (size_t i = 0; i < _counts.size(); ++i)
+            if (_counts[i] != 0)
+                result.push_back(Bucket(std::min(GetHighestEquivalentValue(i), _max), _counts[i]));
+        return result;
+    }
+
+
+    int64_t HdrHistogram::GetHighestEquivalentValue(size_t index) const
+    {
+        int64_t bucket_index = int64_t(index >> _subBucketHalfCountMagnitude) - 1;
+        int64_t sub_bucket_index = int64_t(index & (_subBucketHalfCount - 1)) + _subBucketHalfCount;
+        if (bucket_index < 0)
+        {
+            sub_bucket_index -= _subBucketHalfCount;
+            bucket_index = 0;
+        }
+        return (sub_bucket_index << bucket_index) + (int64_t(1) << bucket_index) - 1;
+    }
+
+}
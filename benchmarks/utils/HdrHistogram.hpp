@@ -0,0 +1,100 @@
+#ifndef BENCHMARKS_CORE_UTILS_HDRHISTOGRAM_HPP
+#define BENCHMARKS_CORE_UTILS_HDRHISTOGRAM_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    class HdrHistogram
+    {
+    public:
+        struct Bucket
+        {
+            int64_t     value;
+            int64_t     count;
+
+            Bucket(int64_t value_, int64_t count_) : value(value_), count(count_) { }
+        };
+
+    private:
+        int64_t                 _highestTrackableValue;
+        int                     _subBucketHalfCountMagnitude;
+        int64_t                 _subBucketHalfCount;
+        int64_t                 _subBucketMask;
+        int64_t                 _subBucketCount;
+        std::vector<int64_t>    _counts;
+        int64_t                 _totalCount;
+        int64_t                 _min;
+        int64_t                 _max;
+        double                  _sum;
+
+    public:
+        HdrHistogram(int64_t highestTrackableValue, int significantDigits = 3);
+
+        void Record(int64_t value, int64_t count = 1)
+        {
+            value = std::max<int64_t>(value, 0);
+            _min = std::min(_min, value);
+            _max = std::max(_max, value);
+            _sum += double(value) * count;
+            _totalCount += count;
+            _counts[GetIndex(value)] += count;
+        }
+
+        void Add(const HdrHistogram& other);
+
+        int64_t GetTotalCount() const { return _totalCount; }
+        int64_t GetMin() const { return _totalCount ? _min : 0; }
+        int64_t GetMax() const { return _max; }
+        double GetMean() const { return _totalCount ? _sum / _totalCount : 0; }
+        int64_t GetValueAtPercentile(double percentile) const;
+        std::vector<Bucket> GetBuckets() const;
+
+        // The buckets layout, lets the values be counted elsewhere (e.g. concurrently) and recorded afterwards
+        size_t GetIndicesCount() const { return _counts.size(); }
+        int64_t GetHighestEquivalentValue(size_t index) const;
+
+        size_t GetIndex(int64_t value) const
+        {
+            value = std::min(std::max<int64_t>(value, 0), _highestTrackableValue);
+            int bucket_index = GetHighestSetBit(value | _subBucketMask) - _subBucketHalfCountMagnitude;
+            int64_t sub_bucket_index = value >> bucket_index;
+            return (size_t)((int64_t(bucket_index) << _subBucketHalfCountMagnitude) + sub_bucket_index);
+        }
+
+    private:
+        static int GetHighestSetBit(uint64_t value)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return (int)index;
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,378 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/Json.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        class JsonParser
+        {
+        private:
+            const std::string&  _str;
+            size_t              _pos;
+
+        public:
+            JsonParser(const std::string& str) : _str(str), _pos(0) { }
+
+            JsonValue ParseDocument()
+            {
+                JsonValue result = ParseValue();
+                SkipWhitespace();
+                if (_pos != _str.size())
+                    Fail("Unexpected trailing characters");
+                return result;
+            }
+
+        private:
+            void Fail(const std::string& msg) const
+            { throw std::runtime_error("JSON parse error at position " + std::to_string(_pos) + ": " + msg); }
+
+            void SkipWhitespace()
+            {
+                while (_pos < _str.size() && (_str[_pos] == ' ' || _str[_pos] == '\t' || _str[_pos] == '\n' || _str[_pos] == '\r'))
+                    ++_pos;
+            }
+
+            char Peek()
+            {
+                SkipWhitespace();
+                if (_pos >= _str.size())
+                    Fail("Unexpected end of input");
+                return _str[_pos];
+            }
+
+            void Expect(char c)
+            {
+                if (Peek() != c)
+                    Fail(std::string("Expected '") + c + "'");
+                ++_pos;
+            }
+
+            void ExpectLiteral(const char* literal)
+            {
+                std::string l(literal);
+                if (_str.compare(_pos, l.size(), l) != 0)
+                    Fail("Expected '" + l + "'");
+                _pos += l.size();
+            }
+
+            JsonValue ParseValue()
+            {
+                switch (Peek())
+                {
+                case '{': return ParseObject();
+                case '[': return ParseArray();
+                case '"': return JsonValue(ParseString());
+                case 't': ExpectLiteral("true"); return JsonValue(true);
+                case 'f': ExpectLiteral("false"); return JsonValue(false);
+                case 'n': ExpectLiteral("null"); return JsonValue();
+                default: return ParseNumber();
+                }
+            }
+
+            JsonValue ParseObject()
+            {
+                Expect('{');
+                JsonValue::Object result;
+                if (Peek() == '}')
+                {
+                    ++_pos;
+                    return JsonValue(result);
+                }
+
+                while (true)
+                {
+                    if (Peek() != '"')
+                        Fail("Expected a string key");
+                    std::string key = ParseString();
+                    Expect(':');
+                    result[key] = ParseValue();
+
+                    char c = Peek();
+                    ++_pos;
+                    if (c == '}')
+                        return JsonValue(result);
+                    if (c != ',')
+                        Fail("Expected ',' or '}'");
+                }
+            }
+
+            JsonValue ParseArray()
+            {
+                Expect('[');
+                JsonValue::Array result;
+                if (Peek() == ']')
+                {
+                    ++_pos;
+                    return JsonValue(result);
+                }
+
+                while (true)
+                {
+                    result.push_back(ParseValue());
+
+                    char c = Peek();
+                    ++_pos;
+                    if (c == ']')
+                        return JsonValue(result);
+                    if (c != ',')
+                        Fail("Expected ',' or ']'");
+                }
+            }
+
+            std::string ParseString()
+            {
+                Expect('"');
+                std::string result;
+                while (true)
+                {
+                    if (_pos >= _str.size())
+                        Fail("Unterminated string");
+
+                    char c = _str[_pos++];
+                    if (c == '"')
+                        return result;
+                    if (c != '\\')
+                    {
+                        result.push_back(c);
+                        continue;
+                    }
+
+                    if (_pos >= _str.size())
+                        Fail("Unterminated string");
+                    switch (_str[_pos++])
+                    {
+                    case '"': result.push_back('"'); break;
+                    case '\\': result.push_back('\\'); break;
+                    case '/': result.push_back('/'); break;
+                    case 'b': result.push_back('\b'); break;
+                    case 'f': result.push_back('\f'); break;
+                    case 'n': result.push_back('\n'); break;
+                    case 'r': result.push_back('\r'); break;
+                    case 't': result.push_back('\t'); break;
+                    case 'u':
+                        {
+                            if (_pos + 4 > _str.size())
+                                Fail("Invalid unicode escape");
+                            unsigned long code = std::strtoul(_str.substr(_pos, 4).c_str(), nullptr, 16);
+                            _pos += 4;
+                            if (code < 0x80)
+                                result.push_back((char)code);
+                            else if (code < 0x800)
+                            {
+                                result.push_back((char)(0xC0 | (code >> 6)));
+                                result.push_back((char)(0x80 | (code & 0x3F)));
+                            }
+                            else
+                            {
+                                result.push_back((char)(0xE0 | (code >> 12)));
+                                result.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                                result.push_back((char)(0x80 | (code & 0x3F)));
+                            }
+                        }
+                        break;
+                    default:
+                        Fail("Invalid escape sequence");
+                    }
+                }
+            }
+
+            JsonValue ParseNumber()
+            {
+                const char* begin = _str.c_str() + _pos;
+                char* end = nullptr;
+                double val = std::strtod(begin, &end);
+                if (end == begin)
+                    Fail("Unexpected character");
+                _pos += end - begin;
+                return JsonValue(val);
+            }
+        };
+
+
+        void WriteString(std::ostream& s, const std::string& str)
+        {
+            s << '"';
+            for (char c : str)
+            {
+                switch (c)
+                {
+                case '"': s << "\\\""; break;
+                case '\\': s << "\\\\"; break;
+                case '\n': s << "\\n"; break;
+                case '\r': s << "\\r"; break;
+                case '\t': s << "\\t"; break;
+                default:
+                    if ((unsigned char)c < 0x20)
+                        s << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+                    else
+                        s << c;
+                }
+            }
+            s << '"';
+        }
+
+        void WriteNumber(std::ostream& s, double val)
+        {
+            if (!std::isfinite(val))
+                s << "null";
+            else if (val == std::floor(val) && std::fabs(val) < 9007199254740992.0)
+                s << (int64_t)val;
+            else
+                s << std::setprecision(std::numeric_limits<double>::digits10) << val;
+        }
+
+        void WriteIndent(std::ostream& s, bool pretty, int indent)
+        {
+            if (pretty)
+                s << std::endl << std::string(indent * 2, ' ');
+        }
+    }
+
+
+    JsonValue JsonValue::Parse(const std::string& str)
+    { return JsonParser(str).ParseDocument(); }
+
+
+    bool JsonValue::AsBool() const
+    {
+        ExpectType(Type::Bool);
+        return _bool;
+    }
+
+    double JsonValue::AsNumber() const
+    {
+        ExpectType(Type::Number);
+        return _number;
+    }
+
+    int64_t JsonValue::AsInt() const
+    {
+        ExpectType(Type::Number);
+        return (int64_t)_number;
+    }
+
+    const std::string& JsonValue::AsString() const
+    {
+        ExpectType(Type::String);
+        return _string;
+    }
+
+    const JsonValue::Array& JsonValue::AsArray() const
+    {
+        ExpectType(Type::Array);
+        return _array;
+    }
+
+    const JsonValue::Object& JsonValue::AsObject() const
+    {
+        ExpectType(Type::Object);
+        return _object;
+    }
+
+
+    bool JsonValue::Has(const std::string& key) const
+    { return _type == Type::Object && _object.find(key) != _object.end(); }
+
+    const JsonValue& JsonValue::Get(const std::string& key) const
+    {
+        ExpectType(Type::Object);
+        auto it = _object.find(key);
+        if (it == _object.end())
+            throw std::runtime_error("JSON object has no '" + key + "' key!");
+        return it->second;
+    }
+
+
+    JsonValue& JsonValue::operator [] (const std::string& key)
+    {
+        if (_type == Type::Null)
+            _type = Type::Object;
+        ExpectType(Type::Object);
+        return _object[key];
+    }
+
+    void JsonValue::Append(JsonValue val)
+    {
+        if (_type == Type::Null)
+            _type = Type::Array;
+        ExpectType(Type::Array);
+        _array.push_back(std::move(val));
+    }
+
+
+    std::string JsonValue::ToString(bool pretty) const
+    {
+        std::stringstream s;
+        Write(s, pretty, 0);
+        return s.str();
+    }
+
+
+    void JsonValue::Write(std::ostream& s, bool pretty, int indent) const
+    {
+        switch (_type)
+        {
+        case Type::Null:
+            s << "null";
+            break;
+        case Type::Bool:
+            s << (_bool ? "true" : "false");
+            break;
+        case Type::Number:
+            WriteNumber(s, _number);
+            break;
+        case Type::String:
+            WriteString(s, _string);
+            break;
+        case Type::Array:
+            s << "[";
+            for (auto it = _array.begin(); it != _array.end(); ++it)
+            {
+                s << (it == _array.begin() ? "" : pretty ? ", " : ",");
+                it->Write(s, pretty, indent);
+            }
+            s << "]";
+            break;
+        case Type::Object:
+            s << "{";
+            for (auto it = _object.begin(); it != _object.end(); ++it)
+            {
+                s << (it == _object.begin() ? "" : ",");
+                WriteIndent(s, pretty, indent + 1);
+                WriteString(s, it->first);
+                s << (pretty ? ": " : ":");
+                it->second.Write(s, pretty, indent + 1);
+            }
+            if (!_object.empty())
+                WriteIndent(s, pretty, indent);
+            s << "}";
+            break;
+        }
+    }
+
+
+    void JsonValue::ExpectType(Type type) const
+    {
+        if (_type != type)
+            throw std::runtime_error("Unexpected JSON value type!");
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef BENCHMARKS_CORE_UTILS_JSON_HPP
+#define BENCHMARKS_CORE_UTILS_JSON_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    class JsonValue
+    {
+    public:
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        using Array = std::vector<JsonValue>;
+        using Object = std::map<std::string, JsonValue>;
+
+    private:
+        Type            _type;
+        bool            _bool;
+        double          _number;
+        std::string     _string;
+        Array           _array;
+        Object          _object;
+
+    public:
+        JsonValue() : _type(Type::Null), _bool(false), _number(0) { }
+        JsonValue(bool val) : _type(Type::Bool), _bool(val), _number(0) { }
+        JsonValue(int val) : _type(Type::Number), _bool(false), _number(val) { }
+        JsonValue(int64_t val) : _type(Type::Number), _bool(false), _number((double)val) { }
+        JsonValue(double val) : _type(Type::Number), _bool(false), _number(val) { }
+        JsonValue(const char* val) : _type(Type::String), _bool(false), _number(0), _string(val) { }
+        JsonValue(std::string val) : _type(Type::String), _bool(false), _number(0), _string(std::move(val)) { }
+        JsonValue(Array val) : _type(Type::Array), _bool(false), _number(0), _array(std::move(val)) { }
+        JsonValue(Object val) : _type(Type::Object), _bool(false), _number(0), _object(std::move(val)) { }
+
+        static JsonValue Parse(const std::string& str);
+
+        Type GetType() const { return _type; }
+        bool IsNull() const { return _type == Type::Null; }
+
+        bool AsBool() const;
+        double AsNumber() const;
+        int64_t AsInt() const;
+        const std::string& AsString() const;
+        const Array& AsArray() const;
+        const Object& AsObject() const;
+
+        bool Has(const std::string& key) const;
+        const JsonValue& Get(const std::string& key) const;
+
+        JsonValue& operator [] (const std::string& key);
+        void Append(JsonValue val);
+
+        std::string ToString(bool pretty = false) const;
+
+    private:
+        void Write(std::ostream& s, bool pretty, int indent) const;
+        void ExpectType(Type type) const;
+    };
+
+}
+
+#endif
@@ -9,16 +9,22 @@
 
 #include <benchmarks/utils/Memory.hpp>
 
-#include <fstream>
 #include <iostream>
 
+#include <stdio.h>
+#include <string.h>
+
 
 #if defined(_WIN32)
 #   include <windows.h>
 #   include <psapi.h>
 #elif defined(__unix__) || defined(__unix) || defined(unix) || (defined(__APPLE__) && defined(__MACH__))
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <sys/resource.h>
+#   if defined(__GLIBC__)
+#       include <malloc.h>
+#   endif
 #   if defined(__APPLE__) && defined(__MACH__)
 #       include <mach/mach.h>
 #       include <mach/message.h>
@@ -50,10 +56,21 @@ namespace benchmarks
 
 #elif defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
 
-        std::ifstream f("/proc/self/statm");
-        int64_t size, rss;
-        f >> size >> rss;
-        return f.bad() ? 0 : (rss * sysconf( _SC_PAGESIZE));
+        static int statm_fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+        if (statm_fd < 0)
+            return 0;
+
+        // No allocations and no stream parsing here, this is called between the measurement barriers
+        char buf[256];
+        ssize_t n = pread(statm_fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0)
+            return 0;
+        buf[n] = '\0';
+
+        long long size = 0, rss = 0;
+        if (sscanf(buf, "%lld %lld", &size, &rss) != 2)
+            return 0;
+        return rss * sysconf(_SC_PAGESIZE);
 
 #else
 
@@ -127,4 +144,80 @@ namespace benchmarks
 #endif
     }
 
+
+    int64_t Memory::GetPeakRss()
+    {
+#if defined(_WIN32)
+
+        PROCESS_MEMORY_COUNTERS info;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+            return 0;
+        return info.PeakWorkingSetSize;
+
+#elif defined(__APPLE__) && defined(__MACH__)
+
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+        return usage.ru_maxrss;
+
+#elif defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+
+        static int status_fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+        if (status_fd < 0)
+            return 0;
+
+        char buf[4096];
+        ssize_t n = pread(status_fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0)
+            return 0;
+        buf[n] = '\0';
+
+        const char* hwm = strstr(buf, "\nVmHWM:");
+        long long kb = 0;
+        if (!hwm || sscanf(hwm + 7, "%lld", &kb) != 1)
+            return 0;
+        return kb * 1024;
+
+#else
+
+        return 0;
+
+#endif
+    }
+
+
+    bool Memory::ResetPeakRss()
+    {
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+
+        int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool result = (write(fd, "5", 1) == 1);
+        close(fd);
+        return result;
+
+#else
+
+        return false;
+
+#endif
+    }
+
+
+    static bool g_releaseFreeMemory = true;
+
+    void Memory::ReleaseFreeMemory()
+    {
+#if defined(__GLIBC__)
+        if (g_releaseFreeMemory)
+            malloc_trim(0);
+#endif
+    }
+
+
+    void Memory::SetReleaseFreeMemoryEnabled(bool enabled)
+    { g_releaseFreeMemory = enabled; }
+
 }
@@ -21,8 +21,12 @@ namespace benchmarks
     {
     public:
         static int64_t GetRss();
+        static int64_t GetPeakRss();
+        static bool ResetPeakRss();
         static int64_t GetTotalPhys();
         static int64_t GetAvailablePhys();
+        static void ReleaseFreeMemory();
+        static void SetReleaseFreeMemoryEnabled(bool enabled);
     };
 
 }
@@ -0,0 +1,188 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/MemoryProbe.hpp>
+
+#include <benchmarks/utils/Memory.hpp>
+
+#include <stdexcept>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_PROC_FS 1
+#   include <fcntl.h>
+#   include <unistd.h>
+#else
+#   define BENCHMARKS_PROC_FS 0
+#endif
+
+#if defined(__GLIBC__)
+#   include <malloc.h>
+#   if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+#       define BENCHMARKS_MALLINFO2 1
+#   else
+#       define BENCHMARKS_MALLINFO2 0
+#   endif
+#endif
+
+
+namespace benchmarks
+{
+
+    MemorySource ParseMemorySource(const std::string& str)
+    {
+        if (str == "rss")
+            return MemorySource::Rss;
+        else if (str == "anon")
+            return MemorySource::Anonymous;
+        else if (str == "file")
+            return MemorySource::FileBacked;
+        else if (str == "heap")
+            return MemorySource::Heap;
+        else
+            throw std::runtime_error("Unknown memory source: '" + str + "'");
+    }
+
+
+    std::string MemorySourceToString(MemorySource source)
+    {
+        switch (source)
+        {
+        case MemorySource::Rss: return "rss";
+        case MemorySource::Anonymous: return "anon";
+        case MemorySource::FileBacked: return "file";
+        case MemorySource::Heap: return "heap";
+        default: return "default";
+        }
+    }
+
+
+#if BENCHMARKS_PROC_FS
+    namespace
+    {
+        // Reads the whole file into a caller-provided buffer, so that probing does not allocate
+        bool PreadText(int fd, char* buf, size_t size)
+        {
+            if (fd < 0)
+                return false;
+            ssize_t n = pread(fd, buf, size - 1, 0);
+            if (n <= 0)
+                return false;
+            buf[n] = '\0';
+            return true;
+        }
+
+        bool FindKbField(const char* buf, const char* key, int64_t& bytes)
+        {
+            size_t key_len = strlen(key);
+            for (const char* line = buf; line; )
+            {
+                if (strncmp(line, key, key_len) == 0 && line[key_len] == ':')
+                {
+                    bytes = strtoll(line + key_len + 1, nullptr, 10) * 1024;
+                    return true;
+                }
+
+                line = strchr(line, '\n');
+                if (line)
+                    ++line;
+            }
+            return false;
+        }
+    }
+#endif
+
+
+    MemoryProbe::MemoryProbe()
+        : _smapsRollupFd(-1)
+    {
+#if BENCHMARKS_PROC_FS
+        _smapsRollupFd = open("/proc/self/smaps_rollup", O_RDONLY | O_CLOEXEC);
+#endif
+    }
+
+
+    MemoryProbe::~MemoryProbe()
+    {
+#if BENCHMARKS_PROC_FS
+        if (_smapsRollupFd >= 0)
+            close(_smapsRollupFd);
+#endif
+    }
+
+
+    bool MemoryProbe::IsAvailable(MemorySource source) const
+    {
+        switch (source)
+        {
+        case MemorySource::Default:
+        case MemorySource::Rss:
+            return true;
+        case MemorySource::Anonymous:
+        case MemorySource::FileBacked:
+            return _smapsRollupFd >= 0;
+        case MemorySource::Heap:
+#if defined(__GLIBC__)
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+
+    int64_t MemoryProbe::Read(MemorySource source) const
+    {
+        switch (source)
+        {
+        case MemorySource::Default:
+        case MemorySource::Rss:
+            return Memory::GetRss();
+        case MemorySource::Anonymous:
+        case MemorySource::FileBacked:
+            return ReadSmapsRollup(source);
+        case MemorySource::Heap:
+            return ReadHeapInUse();
+        }
+        return 0;
+    }
+
+
+    int64_t MemoryProbe::ReadSmapsRollup(MemorySource source) const
+    {
+#if BENCHMARKS_PROC_FS
+        char buf[4096];
+        int64_t rss = 0, anonymous = 0;
+        if (!PreadText(_smapsRollupFd, buf, sizeof(buf)) || !FindKbField(buf, "Rss", rss) || !FindKbField(buf, "Anonymous", anonymous))
+            throw std::runtime_error("Could not read /proc/self/smaps_rollup!");
+        return source == MemorySource::Anonymous ? anonymous : rss - anonymous;
+#else
+        throw std::runtime_error("Memory source " + MemorySourceToString(source) + " is not supported on this platform!");
+#endif
+    }
+
+
+    int64_t MemoryProbe::ReadHeapInUse()
+    {
+#if defined(__GLIBC__)
+#   if BENCHMARKS_MALLINFO2
+        struct mallinfo2 info = mallinfo2();
+#   else
+        struct mallinfo info = mallinfo();
+#   endif
+        return (int64_t)info.uordblks + (int64_t)info.hblkhd;
+#else
+        throw std::runtime_error("Memory source heap is not supported on this platform!");
+#endif
+    }
+
+}
@@ -0,0 +1,57 @@
+#ifndef BENCHMARKS_CORE_UTILS_MEMORYPROBE_HPP
+#define BENCHMARKS_CORE_UTILS_MEMORYPROBE_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <string>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    enum class MemorySource
+    {
+        Default,
+        Rss,
+        Anonymous,
+        FileBacked,
+        Heap
+    };
+
+    MemorySource ParseMemorySource(const std::string& str);
+    std::string MemorySourceToString(MemorySource source);
+
+
+    class MemoryProbe
+    {
+    private:
+        int         _smapsRollupFd;
+
+    public:
+        MemoryProbe();
+        ~MemoryProbe();
+
+        MemoryProbe(const MemoryProbe&) = delete;
+        MemoryProbe& operator = (const MemoryProbe&) = delete;
+
+        bool IsAvailable(MemorySource source) const;
+        int64_t Read(MemorySource source) const;
+
+    private:
+        int64_t ReadSmapsRollup(MemorySource source) const;
+        static int64_t ReadHeapInUse();
+    };
+
+}
+
+#endif
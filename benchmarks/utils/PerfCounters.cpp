@@ -0,0 +1,144 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/PerfCounters.hpp>
+
+#include <benchmarks/utils/Logger.hpp>
+
+#include <string.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_PERF_EVENTS 1
+#   include <errno.h>
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#else
+#   define BENCHMARKS_PERF_EVENTS 0
+#endif
+
+
+namespace benchmarks
+{
+
+    static NamedLogger g_logger("PerfCounters");
+
+#if BENCHMARKS_PERF_EVENTS
+    namespace
+    {
+        struct PerfEventDesc
+        {
+            const char*     name;
+            uint32_t        type;
+            uint64_t        config;
+        };
+
+        uint64_t HwCacheConfig(uint64_t cache, uint64_t op, uint64_t result)
+        { return cache | (op << 8) | (result << 16); }
+
+        const PerfEventDesc g_events[] =
+        {
+            { "cycles",         PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { "instructions",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { "l1d_misses",     PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+            { "llc_misses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { "branch_misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { "dtlb_misses",    PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        };
+
+        int OpenPerfEvent(const PerfEventDesc& desc, int groupFd)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = desc.type;
+            attr.config = desc.config;
+            attr.disabled = (groupFd == -1) ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return (int)syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+        }
+    }
+#endif
+
+
+    PerfCounters::PerfCounters()
+    {
+#if BENCHMARKS_PERF_EVENTS
+        for (auto&& desc : g_events)
+        {
+            int fd = OpenPerfEvent(desc, _fds.empty() ? -1 : _fds.front());
+            if (fd < 0)
+            {
+                g_logger.Debug() << "Could not open " << desc.name << " counter: " << strerror(errno);
+                continue;
+            }
+            _fds.push_back(fd);
+            _names.push_back(desc.name);
+        }
+
+        if (_fds.empty())
+        {
+            g_logger.Warning() << "Hardware performance counters are not available";
+            return;
+        }
+
+        ioctl(_fds.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(_fds.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        g_logger.Warning() << "Hardware performance counters are not supported on this platform";
+#endif
+    }
+
+
+    PerfCounters::~PerfCounters()
+    {
+#if BENCHMARKS_PERF_EVENTS
+        for (auto it = _fds.rbegin(); it != _fds.rend(); ++it)
+            close(*it);
+#endif
+    }
+
+
+    bool PerfCounters::Read(Snapshot& snapshot) const
+    {
+#if BENCHMARKS_PERF_EVENTS
+        if (_fds.empty())
+            return false;
+
+        uint64_t buf[3 + MaxCounters];
+        auto expected_size = (3 + _fds.size()) * sizeof(uint64_t);
+        if (read(_fds.front(), buf, sizeof(buf)) != (ssize_t)expected_size || buf[0] != _fds.size())
+            return false;
+
+        snapshot.timeEnabled = buf[1];
+        snapshot.timeRunning = buf[2];
+        for (size_t i = 0; i < _fds.size(); ++i)
+            snapshot.values[i] = buf[3 + i];
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    bool PerfCounters::GetDelta(const Snapshot& start, const Snapshot& end, size_t index, double& delta)
+    {
+        auto enabled = end.timeEnabled - start.timeEnabled;
+        auto running = end.timeRunning - start.timeRunning;
+        if (running == 0)
+            return false;
+
+        delta = double(end.values[index] - start.values[index]) * enabled / running;
+        return true;
+    }
+
+}
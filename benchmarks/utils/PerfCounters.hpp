@@ -0,0 +1,55 @@
+#ifndef BENCHMARKS_CORE_UTILS_PERFCOUNTERS_HPP
+#define BENCHMARKS_CORE_UTILS_PERFCOUNTERS_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    class PerfCounters
+    {
+    public:
+        static const size_t MaxCounters = 8;
+
+        struct Snapshot
+        {
+            uint64_t    values[MaxCounters];
+            uint64_t    timeEnabled;
+            uint64_t    timeRunning;
+        };
+
+    private:
+        std::vector<std::string>    _names;
+        std::vector<int>            _fds;
+
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator = (const PerfCounters&) = delete;
+
+        bool IsAvailable() const { return !_fds.empty(); }
+        const std::vector<std::string>& GetNames() const { return _names; }
+
+        bool Read(Snapshot& snapshot) const;
+        static bool GetDelta(const Snapshot& start, const Snapshot& end, size_t index, double& delta);
+    };
+
+}
+
+#endif
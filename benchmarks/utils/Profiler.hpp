@@ -11,6 +11,8 @@
 // WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 
+#include <benchmarks/utils/TscClock.hpp>
+
 #include <chrono>
 
 
@@ -37,7 +39,7 @@ namespace benchmarks
         }
     };
 
-    using Profiler = BasicProfiler<std::chrono::high_resolution_clock>;
+    using Profiler = BasicProfiler<TscClock>;
 
 }
 
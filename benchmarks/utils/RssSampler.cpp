@@ -0,0 +1,60 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/RssSampler.hpp>
+
+#include <benchmarks/utils/Memory.hpp>
+
+
+namespace benchmarks
+{
+
+    using namespace std::chrono;
+
+    RssSampler::RssSampler(microseconds interval)
+        : _interval(interval), _stopped(false)
+    {
+        _timeline.reserve(4096);
+        _thread = std::thread(&RssSampler::ThreadFunc, this);
+    }
+
+
+    RssSampler::~RssSampler()
+    { Stop(); }
+
+
+    MemoryTimeline RssSampler::Stop()
+    {
+        {
+            std::unique_lock<std::mutex> l(_mutex);
+            _stopped = true;
+        }
+        _cv.notify_all();
+
+        if (_thread.joinable())
+            _thread.join();
+        return _timeline;
+    }
+
+
+    void RssSampler::ThreadFunc()
+    {
+        auto start = steady_clock::now();
+        std::unique_lock<std::mutex> l(_mutex);
+        while (true)
+        {
+            bool stopped = _stopped;
+            _timeline.push_back(MemoryTimelinePoint(duration<double>(steady_clock::now() - start).count(), Memory::GetRss()));
+            if (stopped)
+                break;
+            _cv.wait_for(l, _interval, [&] { return _stopped; });
+        }
+    }
+
+}
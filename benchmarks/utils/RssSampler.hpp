@@ -0,0 +1,61 @@
+#ifndef BENCHMARKS_CORE_UTILS_RSSSAMPLER_HPP
+#define BENCHMARKS_CORE_UTILS_RSSSAMPLER_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    struct MemoryTimelinePoint
+    {
+        double      seconds;
+        int64_t     bytes;
+
+        MemoryTimelinePoint(double seconds_, int64_t bytes_) : seconds(seconds_), bytes(bytes_) { }
+    };
+    using MemoryTimeline = std::vector<MemoryTimelinePoint>;
+
+
+    class RssSampler
+    {
+    private:
+        std::chrono::microseconds   _interval;
+        std::mutex                  _mutex;
+        std::condition_variable     _cv;
+        bool                        _stopped;
+        MemoryTimeline              _timeline;
+        std::thread                 _thread;
+
+    public:
+        RssSampler(std::chrono::microseconds interval);
+        ~RssSampler();
+
+        RssSampler(const RssSampler&) = delete;
+        RssSampler& operator = (const RssSampler&) = delete;
+
+        MemoryTimeline Stop();
+
+    private:
+        void ThreadFunc();
+    };
+
+}
+
+#endif
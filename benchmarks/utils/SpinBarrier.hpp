@@ -0,0 +1,77 @@
+#ifndef BENCHMARKS_CORE_UTILS_SPINBARRIER_HPP
+#define BENCHMARKS_CORE_UTILS_SPINBARRIER_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <atomic>
+#include <thread>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    inline void CpuRelax()
+    {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+        __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+
+    class SpinBarrier
+    {
+        static const int MaxSpinsBeforeYield = 4096;
+
+    private:
+        const int           _numThreads;
+        std::atomic<int>    _count;
+        std::atomic<int>    _generation;
+
+    public:
+        SpinBarrier(int numThreads)
+            : _numThreads(numThreads), _count(0), _generation(0)
+        { }
+
+        SpinBarrier(const SpinBarrier&) = delete;
+        SpinBarrier& operator = (const SpinBarrier&) = delete;
+
+        void Wait()
+        {
+            int generation = _generation.load(std::memory_order_acquire);
+            if (_count.fetch_add(1, std::memory_order_acq_rel) + 1 == _numThreads)
+            {
+                _count.store(0, std::memory_order_relaxed);
+                _generation.fetch_add(1, std::memory_order_release);
+            }
+            else
+            {
+                for (int i = 0; _generation.load(std::memory_order_acquire) == generation; ++i)
+                {
+                    if (i < MaxSpinsBeforeYield)
+                        CpuRelax();
+                    else
+                        std::this_thread::yield();
+                }
+            }
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,396 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/Statistics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+
+namespace benchmarks
+{
+
+    OutlierRule OutlierRule::Parse(const std::string& str)
+    {
+        auto delim_pos = str.find(':');
+        auto kind_str = str.substr(0, delim_pos);
+
+        Kind kind;
+        double threshold;
+        if (kind_str == "none")
+            return OutlierRule();
+        else if (kind_str == "iqr")
+        {
+            kind = Kind::Iqr;
+            threshold = 1.5;
+        }
+        else if (kind_str == "mad")
+        {
+            kind = Kind::Mad;
+            threshold = 3.0;
+        }
+        else
+            throw std::runtime_error("Unknown outlier rule: '" + str + "'");
+
+        if (delim_pos != std::string::npos)
+            threshold = std::stod(str.substr(delim_pos + 1));
+        if (threshold <= 0)
+            throw std::runtime_error("Invalid outlier rule threshold: '" + str + "'");
+
+        return OutlierRule(kind, threshold);
+    }
+
+
+    std::string OutlierRule::ToString() const
+    {
+        switch (_kind)
+        {
+        case Kind::Iqr: return "iqr:" + std::to_string(_threshold);
+        case Kind::Mad: return "mad:" + std::to_string(_threshold);
+        default: return "none";
+        }
+    }
+
+
+    double Quantile(const std::vector<double>& sortedValues, double q)
+    {
+        if (sortedValues.empty())
+            return 0;
+
+        double pos = q * (sortedValues.size() - 1);
+        size_t idx = (size_t)pos;
+        if (idx + 1 >= sortedValues.size())
+            return sortedValues.back();
+        return sortedValues[idx] + (pos - idx) * (sortedValues[idx + 1] - sortedValues[idx]);
+    }
+
+
+    double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return Quantile(values, 0.5);
+    }
+
+
+    namespace
+    {
+        double SegmentCost(const std::vector<double>& prefixSums, const std::vector<double>& prefixSqSums, size_t begin, size_t end)
+        {
+            double n = (double)(end - begin);
+            double sum = prefixSums[end] - prefixSums[begin];
+            return (prefixSqSums[end] - prefixSqSums[begin]) - sum * sum / n;
+        }
+
+        void SplitSegment(const std::vector<double>& prefixSums, const std::vector<double>& prefixSqSums, size_t begin, size_t end, double penalty, size_t minSegmentSize, std::vector<size_t>& changepoints)
+        {
+            if (end - begin < 2 * minSegmentSize)
+                return;
+
+            double cost = SegmentCost(prefixSums, prefixSqSums, begin, end);
+            double best_gain = 0;
+            size_t best_split = 0;
+            for (size_t split = begin + minSegmentSize; split + minSegmentSize <= end; ++split)
+            {
+                double gain = cost - SegmentCost(prefixSums, prefixSqSums, begin, split) - SegmentCost(prefixSums, prefixSqSums, split, end);
+                if (gain > best_gain)
+                {
+                    best_gain = gain;
+                    best_split = split;
+                }
+            }
+
+            if (best_gain <= penalty)
+                return;
+
+            SplitSegment(prefixSums, prefixSqSums, begin, best_split, penalty, minSegmentSize, changepoints);
+            changepoints.push_back(best_split);
+            SplitSegment(prefixSums, prefixSqSums, best_split, end, penalty, minSegmentSize, changepoints);
+        }
+    }
+
+
+    std::vector<size_t> DetectChangepoints(const std::vector<double>& series, double penalty, size_t minSegmentSize)
+    {
+        std::vector<size_t> result;
+        if (series.size() < 2 * std::max<size_t>(minSegmentSize, 1))
+            return result;
+
+        const double mad_to_sigma = 1.4826;
+        std::vector<double> differences;
+        for (size_t i = 1; i < series.size(); ++i)
+            differences.push_back(series[i] - series[i - 1]);
+        double differences_median = Median(differences);
+        for (auto& d : differences)
+            d = std::fabs(d - differences_median);
+        double sigma = Median(differences) * mad_to_sigma / std::sqrt(2.0);
+        if (sigma <= 0)
+            sigma = std::max(std::fabs(Median(series)) * 1e-6, 1e-12);
+
+        std::vector<double> prefix_sums(series.size() + 1, 0), prefix_sq_sums(series.size() + 1, 0);
+        for (size_t i = 0; i < series.size(); ++i)
+        {
+            prefix_sums[i + 1] = prefix_sums[i] + series[i];
+            prefix_sq_sums[i + 1] = prefix_sq_sums[i] + series[i] * series[i];
+        }
+
+        SplitSegment(prefix_sums, prefix_sq_sums, 0, series.size(), penalty * sigma * sigma, std::max<size_t>(minSegmentSize, 1), result);
+        return result;
+    }
+
+
+    namespace
+    {
+        // Two-sided p-value of the exact null distribution of U built by counting the orderings
+        double ExactMannWhitneyPValue(size_t n1, size_t n2, double u)
+        {
+            size_t max_u = n1 * n2;
+            // counts[j][k]: orderings of i elements of the first sample and j of the second one with U = k
+            std::vector<std::vector<double>> counts(n2 + 1, std::vector<double>(max_u + 1, 0));
+            for (size_t j = 0; j <= n2; ++j)
+                counts[j][0] = 1;
+            for (size_t i = 1; i <= n1; ++i)
+            {
+                std::vector<std::vector<double>> next(n2 + 1, std::vector<double>(max_u + 1, 0));
+                for (size_t j = 0; j <= n2; ++j)
+                    for (size_t k = 0; k <= i * j; ++k)
+                        next[j][k] = (k >= j ? counts[j][k - j] : 0) + (j > 0 ? next[j - 1][k] : 0);
+                counts.swap(next);
+            }
+
+            double total = 0, below = 0, above = 0;
+            for (size_t k = 0; k <= max_u; ++k)
+            {
+                total += counts[n2][k];
+                if (k <= u)
+                    below += counts[n2][k];
+                if (k >= u)
+                    above += counts[n2][k];
+            }
+            return std::min(1.0, 2 * std::min(below, above) / total);
+        }
+    }
+
+
+    MannWhitneyResult MannWhitneyUTest(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        const size_t exact_max_size = 50;
+
+        if (a.empty() || b.empty())
+            return MannWhitneyResult(0, 1);
+
+        std::vector<std::pair<double, size_t>> values;
+        for (double v : a)
+            values.push_back(std::make_pair(v, 0));
+        for (double v : b)
+            values.push_back(std::make_pair(v, 1));
+        std::sort(values.begin(), values.end());
+
+        double rank_sum = 0, ties_correction = 0;
+        bool has_ties = false;
+        for (size_t i = 0; i < values.size(); )
+        {
+            size_t j = i;
+            while (j < values.size() && values[j].first == values[i].first)
+                ++j;
+            double t = (double)(j - i);
+            double rank = (i + j + 1) / 2.0;
+            for (size_t k = i; k < j; ++k)
+                if (values[k].second == 0)
+                    rank_sum += rank;
+            ties_correction += t * t * t - t;
+            has_ties = has_ties || t > 1;
+            i = j;
+        }
+
+        double n1 = (double)a.size(), n2 = (double)b.size(), n = n1 + n2;
+        double u = rank_sum - n1 * (n1 + 1) / 2;
+
+        if (!has_ties && a.size() <= exact_max_size && b.size() <= exact_max_size)
+            return MannWhitneyResult(u, ExactMannWhitneyPValue(a.size(), b.size(), u));
+
+        double mean = n1 * n2 / 2;
+        double variance = n1 * n2 / 12 * ((n + 1) - ties_correction / (n * (n - 1)));
+        if (variance <= 0)
+            return MannWhitneyResult(u, 1);
+
+        double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+        return MannWhitneyResult(u, std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0))));
+    }
+
+
+    double WilcoxonSignedRankTest(const std::vector<double>& differences)
+    {
+        const size_t exact_max_size = 50;
+
+        std::vector<double> abs_values;
+        for (double d : differences)
+            if (d != 0)
+                abs_values.push_back(std::fabs(d));
+        std::sort(abs_values.begin(), abs_values.end());
+
+        size_t n = abs_values.size();
+        if (n == 0)
+            return 1;
+
+        double w_plus = 0, ties_correction = 0;
+        bool has_ties = false;
+        for (size_t i = 0; i < n; )
+        {
+            size_t j = i;
+            while (j < n && abs_values[j] == abs_values[i])
+                ++j;
+            double t = (double)(j - i);
+            double rank = (i + j + 1) / 2.0;
+            for (double d : differences)
+                if (d > 0 && std::fabs(d) == abs_values[i])
+                    w_plus += rank;
+            ties_correction += t * t * t - t;
+            has_ties = has_ties || t > 1;
+            i = j;
+        }
+
+        if (!has_ties && n <= exact_max_size)
+        {
+            // counts[s]: subsets of the ranks 1..n that sum to s
+            size_t max_sum = n * (n + 1) / 2;
+            std::vector<double> counts(max_sum + 1, 0);
+            counts[0] = 1;
+            for (size_t r = 1; r <= n; ++r)
+                for (size_t sum = max_sum; sum >= r; --sum)
+                    counts[sum] += counts[sum - r];
+
+            double total = 0, below = 0, above = 0;
+            for (size_t sum = 0; sum <= max_sum; ++sum)
+            {
+                total += counts[sum];
+                if (sum <= w_plus)
+                    below += counts[sum];
+                if (sum >= w_plus)
+                    above += counts[sum];
+            }
+            return std::min(1.0, 2 * std::min(below, above) / total);
+        }
+
+        double nn = (double)n;
+        double mean = nn * (nn + 1) / 4;
+        double variance = nn * (nn + 1) * (2 * nn + 1) / 24 - ties_correction / 48;
+        if (variance <= 0)
+            return 1;
+
+        double z = (std::fabs(w_plus - mean) - 0.5) / std::sqrt(variance);
+        return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+    }
+
+
+    std::vector<double> HolmCorrection(const std::vector<double>& pValues)
+    {
+        std::vector<size_t> order(pValues.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t l, size_t r) { return pValues[l] < pValues[r]; });
+
+        std::vector<double> result(pValues.size());
+        double running_max = 0;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            running_max = std::max(running_max, std::min(1.0, (order.size() - k) * pValues[order[k]]));
+            result[order[k]] = running_max;
+        }
+        return result;
+    }
+
+
+    SampleStatistics SampleStatistics::Compute(std::vector<double> samples, const OutlierRule& outlierRule, double confidence, int bootstrapResamples)
+    {
+        SampleStatistics result;
+        result._samples = samples;
+        result._confidence = confidence;
+        if (samples.empty())
+            return result;
+
+        std::sort(samples.begin(), samples.end());
+
+        double low_fence = samples.front(), high_fence = samples.back();
+        switch (outlierRule.GetKind())
+        {
+        case OutlierRule::Kind::Iqr:
+            {
+                double q1 = Quantile(samples, 0.25), q3 = Quantile(samples, 0.75);
+                low_fence = q1 - outlierRule.GetThreshold() * (q3 - q1);
+                high_fence = q3 + outlierRule.GetThreshold() * (q3 - q1);
+            }
+            break;
+        case OutlierRule::Kind::Mad:
+            {
+                const double mad_to_sigma = 1.4826;
+                double median = Quantile(samples, 0.5);
+                std::vector<double> deviations;
+                for (double s : samples)
+                    deviations.push_back(std::fabs(s - median));
+                double sigma = Median(deviations) * mad_to_sigma;
+                low_fence = median - outlierRule.GetThreshold() * sigma;
+                high_fence = median + outlierRule.GetThreshold() * sigma;
+            }
+            break;
+        default:
+            break;
+        }
+
+        std::vector<double> kept;
+        for (double s : samples)
+            if (s >= low_fence && s <= high_fence)
+                kept.push_back(s);
+        // A tight threshold may reject every sample (e.g. MAD with an even count, where the median is not a sample)
+        if (kept.empty())
+            kept = samples;
+        result._numOutliers = samples.size() - kept.size();
+
+        result._min = kept.front();
+        result._max = kept.back();
+        result._median = Quantile(kept, 0.5);
+
+        double sum = 0;
+        for (double s : kept)
+            sum += s;
+        result._mean = sum / kept.size();
+
+        double sq_sum = 0;
+        std::vector<double> deviations;
+        for (double s : kept)
+        {
+            sq_sum += (s - result._mean) * (s - result._mean);
+            deviations.push_back(std::fabs(s - result._median));
+        }
+        result._stdDev = kept.size() > 1 ? std::sqrt(sq_sum / (kept.size() - 1)) : 0;
+        result._mad = Median(deviations);
+
+        result._ciLow = result._ciHigh = result._median;
+        if (kept.size() > 1 && bootstrapResamples > 0)
+        {
+            std::mt19937 rng(12345);
+            std::uniform_int_distribution<size_t> index_dist(0, kept.size() - 1);
+            std::vector<double> medians, resample(kept.size());
+            medians.reserve(bootstrapResamples);
+            for (int i = 0; i < bootstrapResamples; ++i)
+            {
+                for (auto& r : resample)
+                    r = kept[index_dist(rng)];
+                medians.push_back(Median(resample));
+            }
+            std::sort(medians.begin(), medians.end());
+            result._ciLow = Quantile(medians, (1 - confidence) / 2);
+            result._ciHigh = Quantile(medians, (1 + confidence) / 2);
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,110 @@
+#ifndef BENCHMARKS_CORE_UTILS_STATISTICS_HPP
+#define BENCHMARKS_CORE_UTILS_STATISTICS_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <string>
+#include <vector>
+
+
+namespace benchmarks
+{
+
+    class OutlierRule
+    {
+    public:
+        enum class Kind
+        {
+            None,
+            Iqr,
+            Mad
+        };
+
+    private:
+        Kind        _kind;
+        double      _threshold;
+
+    public:
+        OutlierRule() : _kind(Kind::None), _threshold(0) { }
+        OutlierRule(Kind kind, double threshold) : _kind(kind), _threshold(threshold) { }
+
+        static OutlierRule Parse(const std::string& str);
+
+        Kind GetKind() const { return _kind; }
+        double GetThreshold() const { return _threshold; }
+
+        std::string ToString() const;
+    };
+
+
+    class SampleStatistics
+    {
+    private:
+        std::vector<double>     _samples;
+        size_t                  _numOutliers;
+        double                  _median;
+        double                  _mean;
+        double                  _stdDev;
+        double                  _mad;
+        double                  _min;
+        double                  _max;
+        double                  _confidence;
+        double                  _ciLow;
+        double                  _ciHigh;
+
+    public:
+        SampleStatistics()
+            : _numOutliers(0), _median(0), _mean(0), _stdDev(0), _mad(0), _min(0), _max(0), _confidence(0), _ciLow(0), _ciHigh(0)
+        { }
+
+        static SampleStatistics Compute(std::vector<double> samples, const OutlierRule& outlierRule, double confidence, int bootstrapResamples);
+
+        const std::vector<double>& GetSamples() const { return _samples; }
+        size_t GetNumOutliers() const { return _numOutliers; }
+        double GetMedian() const { return _median; }
+        double GetMean() const { return _mean; }
+        double GetStdDev() const { return _stdDev; }
+        double GetMad() const { return _mad; }
+        double GetMin() const { return _min; }
+        double GetMax() const { return _max; }
+        double GetConfidence() const { return _confidence; }
+        double GetCiLow() const { return _ciLow; }
+        double GetCiHigh() const { return _ciHigh; }
+    };
+
+
+    double Median(std::vector<double> values);
+    double Quantile(const std::vector<double>& sortedValues, double q);
+
+    // Binary segmentation of a series into segments with different means, returns the indices where new segments start.
+    // The penalty is in units of the noise variance which is estimated from the successive differences.
+    std::vector<size_t> DetectChangepoints(const std::vector<double>& series, double penalty, size_t minSegmentSize);
+
+
+    struct MannWhitneyResult
+    {
+        double      u;          // U statistic of the first sample
+        double      pValue;     // two-sided, exact for small samples without ties, normal approximation otherwise
+
+        MannWhitneyResult(double u, double pValue) : u(u), pValue(pValue) { }
+    };
+
+    MannWhitneyResult MannWhitneyUTest(const std::vector<double>& a, const std::vector<double>& b);
+
+    // Two-sided p-value of the Wilcoxon signed-rank test of the paired differences (zero differences are dropped)
+    double WilcoxonSignedRankTest(const std::vector<double>& differences);
+
+    // Holm-Bonferroni adjusted p-values in the order of the input
+    std::vector<double> HolmCorrection(const std::vector<double>& pValues);
+
+}
+
+#endif
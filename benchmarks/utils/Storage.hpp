@@ -11,6 +11,14 @@
 // WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 
+#include <benchmarks/utils/AllocationPolicy.hpp>
+
+#include <new>
+#include <utility>
+
+#include <stdint.h>
+
+
 namespace benchmarks
 {
 
@@ -48,16 +56,20 @@ namespace benchmarks
     class StorageArray
     {
     private:
+        MemoryBlock         _block;
         Storage<T_>*        _arr;
-        int64_t         _size;
+        int64_t             _size;
 
     public:
-        StorageArray(int64_t size)
-            : _size(size)
-        { _arr = new Storage<T_>[size]; }
+        StorageArray(int64_t size, const AllocationPolicy& policy = AllocationPolicy::GetDefault())
+            : _block(sizeof(Storage<T_>) * size, policy, alignof(Storage<T_>)), _arr(static_cast<Storage<T_>*>(_block.Get())), _size(size)
+        {
+            for (int64_t i = 0; i < _size; ++i)
+                new(&_arr[i]) Storage<T_>();
+        }
 
-        ~StorageArray()
-        { delete[] _arr; }
+        const AllocationPolicy& GetActualPolicy() const
+        { return _block.GetActualPolicy(); }
 
 
         void Construct()
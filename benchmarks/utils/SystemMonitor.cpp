@@ -0,0 +1,266 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/SystemMonitor.hpp>
+
+#include <benchmarks/utils/TscClock.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <stdlib.h>
+
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+#   define BENCHMARKS_SYSFS 1
+#   include <fcntl.h>
+#   include <sched.h>
+#   include <sys/utsname.h>
+#   include <unistd.h>
+#else
+#   define BENCHMARKS_SYSFS 0
+#endif
+
+
+namespace benchmarks
+{
+
+    NoisePolicy ParseNoisePolicy(const std::string& str)
+    {
+        if (str == "ignore")
+            return NoisePolicy::Ignore;
+        else if (str == "warn")
+            return NoisePolicy::Warn;
+        else if (str == "abort")
+            return NoisePolicy::Abort;
+        else
+            throw std::runtime_error("Unknown noise policy: '" + str + "'");
+    }
+
+
+    std::string NoisePolicyToString(NoisePolicy policy)
+    {
+        switch (policy)
+        {
+        case NoisePolicy::Ignore: return "ignore";
+        case NoisePolicy::Abort: return "abort";
+        default: return "warn";
+        }
+    }
+
+
+    namespace
+    {
+        std::string CpuSysfsPath(int cpu, const std::string& file)
+        { return "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/" + file; }
+
+        bool ReadLine(const std::string& path, std::string& line)
+        {
+            std::ifstream f(path);
+            return std::getline(f, line) && !line.empty();
+        }
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+
+    CpuFrequencyProbe::~CpuFrequencyProbe()
+    {
+#if BENCHMARKS_SYSFS
+        for (int fd : _fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+
+    int64_t CpuFrequencyProbe::ReadKhz(int cpu) const
+    {
+#if BENCHMARKS_SYSFS
+        const int not_opened = -2;
+        if (cpu < 0)
+            return 0;
+        if ((size_t)cpu >= _fds.size())
+            _fds.resize(cpu + 1, not_opened);
+        int& fd = _fds[cpu];
+        if (fd == not_opened)
+            fd = open(CpuSysfsPath(cpu, "cpufreq/scaling_cur_freq").c_str(), O_RDONLY | O_CLOEXEC);
+
+        char buf[64];
+        ssize_t n = fd < 0 ? -1 : pread(fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0)
+            return 0;
+        buf[n] = '\0';
+        return strtoll(buf, nullptr, 10);
+#else
+        return 0;
+#endif
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+
+    BENCHMARKS_LOGGER(SystemMonitor);
+
+    int SystemMonitor::GetCurrentCpu()
+    {
+#if BENCHMARKS_SYSFS
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+
+    int64_t SystemMonitor::GetInterruptsCount(int cpu)
+    {
+        std::ifstream f("/proc/interrupts");
+        std::string header;
+        if (cpu < 0 || !std::getline(f, header))
+            return 0;
+
+        std::stringstream header_stream(header);
+        std::string cpu_name;
+        int column = -1;
+        for (int i = 0; header_stream >> cpu_name; ++i)
+            if (cpu_name == "CPU" + std::to_string(cpu))
+                column = i;
+        if (column < 0)
+            return 0;
+
+        int64_t result = 0;
+        std::string line;
+        while (std::getline(f, line))
+        {
+            std::stringstream s(line);
+            std::string irq;
+            s >> irq;
+            int64_t count = 0;
+            for (int i = 0; i <= column && s >> count; ++i)
+                if (i == column)
+                    result += count;
+        }
+        return result;
+    }
+
+
+    JitterReport SystemMonitor::MeasureJitter(std::chrono::milliseconds duration, std::chrono::nanoseconds threshold)
+    {
+        using namespace std::chrono;
+
+        JitterReport result;
+        int cpu = GetCurrentCpu();
+        int64_t interrupts_start = GetInterruptsCount(cpu);
+
+        auto start = TscClock::now();
+        auto end = start + duration_cast<TscClock::duration>(duration);
+        auto prev = start;
+        for (auto now = start; now < end; now = TscClock::now())
+        {
+            auto gap = now - prev;
+            if (gap > threshold)
+            {
+                ++result.interruptions;
+                result.totalNs += gap.count();
+                result.maxNs = std::max(result.maxNs, (double)gap.count());
+            }
+            prev = now;
+        }
+        result.durationNs = (double)(prev - start).count();
+        result.interrupts = GetInterruptsCount(cpu) - interrupts_start;
+        return result;
+    }
+
+
+    JsonValue SystemMonitor::RunPreflight(NoisePolicy policy, std::chrono::milliseconds jitterCheckDuration, std::chrono::nanoseconds jitterThreshold, bool forbidTurbo)
+    {
+        JsonValue result;
+        std::vector<std::string> issues;
+
+        int cpu = GetCurrentCpu();
+        int num_cpus = std::max(1, (int)std::thread::hardware_concurrency());
+        result["cpu"] = cpu;
+        result["num_cpus"] = num_cpus;
+        result["clock"] = TscClock::GetDescription();
+
+#if BENCHMARKS_SYSFS
+        struct utsname uts;
+        if (uname(&uts) == 0)
+            result["kernel"] = std::string(uts.release);
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        for (std::string line; std::getline(cpuinfo, line); )
+            if (line.compare(0, 10, "model name") == 0)
+            {
+                result["cpu_model"] = line.substr(line.find(':') + 2);
+                break;
+            }
+
+        std::string value;
+        if (ReadLine(CpuSysfsPath(cpu, "cpufreq/scaling_governor"), value))
+        {
+            result["governor"] = value;
+            if (value != "performance")
+                issues.push_back("CPU frequency governor is '" + value + "', not 'performance'");
+        }
+        char* end = nullptr;
+        int64_t frequency_khz = 0;
+        if (ReadLine(CpuSysfsPath(cpu, "cpufreq/scaling_cur_freq"), value) && (frequency_khz = strtoll(value.c_str(), &end, 10)) > 0 && *end == '\0')
+            result["frequency_khz"] = frequency_khz;
+        if (ReadLine("/sys/devices/system/cpu/intel_pstate/no_turbo", value))
+            result["turbo"] = (value == "0");
+        else if (ReadLine("/sys/devices/system/cpu/cpufreq/boost", value))
+            result["turbo"] = (value == "1");
+        if (forbidTurbo && result.Has("turbo") && result.Get("turbo").AsBool())
+            issues.push_back("Turbo boost is enabled");
+        if (ReadLine(CpuSysfsPath(cpu, "topology/thread_siblings_list"), value))
+            result["smt_siblings"] = value;
+
+        double load[3] = { };
+        if (getloadavg(load, 3) == 3)
+        {
+            result["load_average"] = JsonValue::Array{ load[0], load[1], load[2] };
+            if (load[0] / num_cpus > 1.0)
+                issues.push_back("Load average is " + std::to_string(load[0]) + " on " + std::to_string(num_cpus) + " CPUs");
+        }
+        result["interrupts"] = GetInterruptsCount(cpu);
+#endif
+
+        if (jitterCheckDuration.count() > 0)
+        {
+            auto jitter = MeasureJitter(jitterCheckDuration, jitterThreshold);
+            JsonValue& j = result["jitter"];
+            j["threshold_ns"] = (int64_t)jitterThreshold.count();
+            j["duration_ns"] = jitter.durationNs;
+            j["interruptions"] = jitter.interruptions;
+            j["max_ns"] = jitter.maxNs;
+            j["total_ns"] = jitter.totalNs;
+            j["interrupts"] = jitter.interrupts;
+            if (jitter.durationNs > 0 && jitter.totalNs / jitter.durationNs > 0.01)
+                issues.push_back("OS jitter takes " + std::to_string(100 * jitter.totalNs / jitter.durationNs) + "% of the time");
+        }
+
+        result["issues"] = JsonValue::Array();
+        for (auto&& issue : issues)
+        {
+            result["issues"].Append(issue);
+            if (policy != NoisePolicy::Ignore)
+                s_logger.Warning() << issue;
+        }
+
+        if (policy == NoisePolicy::Abort && !issues.empty())
+            throw std::runtime_error("The system is too noisy for benchmarking: " + issues.front());
+
+        return result;
+    }
+
+}
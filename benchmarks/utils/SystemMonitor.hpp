@@ -0,0 +1,84 @@
+#ifndef BENCHMARKS_CORE_UTILS_SYSTEMMONITOR_HPP
+#define BENCHMARKS_CORE_UTILS_SYSTEMMONITOR_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/utils/Json.hpp>
+#include <benchmarks/utils/Logger.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    enum class NoisePolicy
+    {
+        Ignore,
+        Warn,
+        Abort
+    };
+
+    NoisePolicy ParseNoisePolicy(const std::string& str);
+    std::string NoisePolicyToString(NoisePolicy policy);
+
+
+    struct JitterReport
+    {
+        int64_t     interruptions;
+        double      maxNs;
+        double      totalNs;
+        double      durationNs;
+        int64_t     interrupts;
+
+        JitterReport() : interruptions(0), maxNs(0), totalNs(0), durationNs(0), interrupts(0) { }
+    };
+
+
+    class SystemMonitor
+    {
+    private:
+        static NamedLogger      s_logger;
+
+    public:
+        static int GetCurrentCpu();
+        static int64_t GetInterruptsCount(int cpu);
+        static JitterReport MeasureJitter(std::chrono::milliseconds duration, std::chrono::nanoseconds threshold);
+
+        // Turbo boost is only reported, unless forbidTurbo is set
+        static JsonValue RunPreflight(NoisePolicy policy, std::chrono::milliseconds jitterCheckDuration, std::chrono::nanoseconds jitterThreshold, bool forbidTurbo = false);
+    };
+
+
+    // Reads the current frequency of any CPU, the sysfs files are opened on the first read of each CPU
+    class CpuFrequencyProbe
+    {
+    private:
+        mutable std::vector<int>    _fds;
+
+    public:
+        CpuFrequencyProbe() { }
+        ~CpuFrequencyProbe();
+
+        CpuFrequencyProbe(const CpuFrequencyProbe&) = delete;
+        CpuFrequencyProbe& operator = (const CpuFrequencyProbe&) = delete;
+
+        bool IsAvailable() const { return ReadKhz(SystemMonitor::GetCurrentCpu()) > 0; }
+        int64_t ReadKhz(int cpu) const;
+    };
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/ThreadCounts.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        int ParseThreadCount(const std::string& str)
+        {
+            if (str == "ncores")
+                return std::max(1, (int)std::thread::hardware_concurrency());
+
+            size_t pos = 0;
+            int result = std::stoi(str, &pos);
+            if (pos != str.size() || result <= 0)
+                throw std::runtime_error("Invalid thread count: '" + str + "'");
+            return result;
+        }
+    }
+
+
+    ThreadCounts ThreadCounts::Parse(const std::string& str)
+    {
+        std::vector<std::string> tokens;
+        for (size_t pos = 0; pos <= str.size(); )
+        {
+            auto delim_pos = std::min(str.find(',', pos), str.size());
+            tokens.push_back(str.substr(pos, delim_pos - pos));
+            pos = delim_pos + 1;
+        }
+
+        std::vector<int> result;
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            if (tokens[i] != "...")
+            {
+                int count = ParseThreadCount(tokens[i]);
+                if (std::find(result.begin(), result.end(), count) == result.end())
+                    result.push_back(count);
+                continue;
+            }
+
+            if (result.size() < 2 || i + 1 == tokens.size())
+                throw std::runtime_error("'...' in '" + str + "' must be preceded by two thread counts and followed by one");
+
+            int first = result[result.size() - 2], second = result.back();
+            int last = ParseThreadCount(tokens[i + 1]);
+            if (second <= first)
+                throw std::runtime_error("Thread counts before '...' in '" + str + "' must increase");
+
+            bool geometric = (second % first == 0) && (second / first > 1);
+            for (int next = geometric ? second * (second / first) : second + (second - first); next < last; next = geometric ? next * (second / first) : next + (second - first))
+                result.push_back(next);
+        }
+
+        return ThreadCounts(result);
+    }
+
+
+    std::string ThreadCounts::ToString() const
+    {
+        std::string result;
+        for (auto it = _counts.begin(); it != _counts.end(); ++it)
+            result += (it == _counts.begin() ? "" : ",") + std::to_string(*it);
+        return result;
+    }
+
+
+    std::istream& operator >> (std::istream& s, ThreadCounts& threadCounts)
+    {
+        std::string str;
+        s >> str;
+        threadCounts = ThreadCounts::Parse(str);
+        return s;
+    }
+
+}
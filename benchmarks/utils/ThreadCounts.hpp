@@ -0,0 +1,42 @@
+#ifndef BENCHMARKS_CORE_UTILS_THREADCOUNTS_HPP
+#define BENCHMARKS_CORE_UTILS_THREADCOUNTS_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <istream>
+#include <string>
+#include <vector>
+
+
+namespace benchmarks
+{
+
+    class ThreadCounts
+    {
+    private:
+        std::vector<int>    _counts;
+
+    public:
+        ThreadCounts() { }
+        ThreadCounts(std::vector<int> counts) : _counts(std::move(counts)) { }
+
+        static ThreadCounts Parse(const std::string& str);
+
+        const std::vector<int>& Get() const { return _counts; }
+
+        std::string ToString() const;
+    };
+
+    std::istream& operator >> (std::istream& s, ThreadCounts& threadCounts);
+
+}
+
+#endif
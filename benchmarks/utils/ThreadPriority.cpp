@@ -27,7 +27,7 @@ namespace benchmarks
 
     static NamedLogger g_logger("ThreadPriority");
 
-    void SetMaxThreadPriority()
+    bool SetMaxThreadPriority()
     {
 #if defined(__unix__) || defined(__unix) || defined(unix) || (defined(__APPLE__) && defined(__MACH__))
         int policy = SCHED_FIFO;
@@ -35,16 +35,23 @@ namespace benchmarks
         scheduler_params.sched_priority = sched_get_priority_max(policy);
         int res = pthread_setschedparam(pthread_self(), policy, &scheduler_params);
         if (res != 0)
+        {
             g_logger.Debug() << "Could not set thread priority: " << strerror(res);
-#endif
-#if _WIN32
+            return false;
+        }
+        return true;
+#elif _WIN32
         if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
         {
             DWORD err = GetLastError();
             char buf[256] = { '\0' };
             FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM, NULL, err, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf, sizeof(buf) - 1, NULL);
             g_logger.Debug() << "Could not set thread priority: " << buf;
+            return false;
         }
+        return true;
+#else
+        return false;
 #endif
     }
 
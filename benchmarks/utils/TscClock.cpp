@@ -0,0 +1,114 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/utils/TscClock.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#   include <cpuid.h>
+#endif
+
+
+namespace benchmarks
+{
+
+    namespace
+    {
+        bool HasInvariantTsc()
+        {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 27)))
+                return false;
+            if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+                return false;
+            return (edx & (1u << 8)) != 0;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            int regs[4];
+            __cpuid(regs, 0x80000000);
+            if ((unsigned int)regs[0] < 0x80000007)
+                return false;
+            __cpuid(regs, 0x80000001);
+            if (!(regs[3] & (1 << 27)))
+                return false;
+            __cpuid(regs, 0x80000007);
+            return (regs[3] & (1 << 8)) != 0;
+#else
+            return false;
+#endif
+        }
+
+        double MeasureNanosecondsPerTick(std::chrono::microseconds interval)
+        {
+            using namespace std::chrono;
+
+            auto start = steady_clock::now();
+            auto start_ticks = TscClock::ReadTicks();
+            auto end = start;
+            while (end - start < interval)
+                end = steady_clock::now();
+            auto end_ticks = TscClock::ReadTicks();
+
+            if (end_ticks <= start_ticks)
+                return 0;
+            return duration_cast<duration<double, std::nano>>(end - start).count() / (end_ticks - start_ticks);
+        }
+    }
+
+
+    TscClock::Calibration::Calibration()
+        : reliable(false), nsPerTick(0), baseTicks(0)
+    {
+        const int num_rounds = 5;
+
+        if (!HasInvariantTsc())
+            return;
+
+        std::vector<double> rounds;
+        for (int i = 0; i < num_rounds; ++i)
+            rounds.push_back(MeasureNanosecondsPerTick(std::chrono::milliseconds(2)));
+        std::sort(rounds.begin(), rounds.end());
+
+        double median = rounds[num_rounds / 2];
+        if (median <= 0 || (rounds[num_rounds - 2] - rounds[1]) / median > 0.005)
+            return;
+
+        nsPerTick = median;
+        baseTicks = ReadTicks();
+        reliable = true;
+    }
+
+
+    void TscClock::UseNanosecondsPerTick(double nsPerTick)
+    {
+        Calibration& c = GetCalibration();
+        if (nsPerTick <= 0 || (c.reliable && c.nsPerTick == nsPerTick))
+            return;
+
+        c.nsPerTick = nsPerTick;
+        if (!c.reliable)
+            c.baseTicks = ReadTicks();
+        c.reliable = true;
+    }
+
+
+    std::string TscClock::GetDescription()
+    {
+        std::stringstream s;
+        if (IsReliable())
+            s << "tsc (" << 1.0 / GetNanosecondsPerTick() << " GHz)";
+        else
+            s << "steady_clock (invariant TSC is not available)";
+        return s.str();
+    }
+
+}
@@ -0,0 +1,93 @@
+#ifndef BENCHMARKS_CORE_UTILS_TSCCLOCK_HPP
+#define BENCHMARKS_CORE_UTILS_TSCCLOCK_HPP
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <chrono>
+#include <string>
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#   include <x86intrin.h>
+#   define BENCHMARKS_HAS_TSC 1
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   include <intrin.h>
+#   define BENCHMARKS_HAS_TSC 1
+#else
+#   define BENCHMARKS_HAS_TSC 0
+#endif
+
+
+namespace benchmarks
+{
+
+    class TscClock
+    {
+    public:
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<TscClock>;
+        static const bool is_steady = true;
+
+    private:
+        // Takes about 10 ms, so it is done on the first use instead of the static initialization
+        struct Calibration
+        {
+            bool        reliable;
+            double      nsPerTick;
+            uint64_t    baseTicks; // the ticks are counted from here, so that the double keeps the sub-nanosecond precision
+
+            Calibration();
+        };
+
+    public:
+        static time_point now()
+        {
+            const Calibration& c = GetCalibration();
+            if (c.reliable)
+                return time_point(duration((rep)((int64_t)(ReadTicks() - c.baseTicks) * c.nsPerTick)));
+            return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()));
+        }
+
+        static bool IsReliable() { return GetCalibration().reliable; }
+        static double GetNanosecondsPerTick() { return GetCalibration().nsPerTick; }
+        static std::string GetDescription();
+
+        // Replaces the own calibration, so that the suite libraries convert the ticks exactly as the host does.
+        // Must not be called while the clock is used by other threads.
+        static void UseNanosecondsPerTick(double nsPerTick);
+
+        static uint64_t ReadTicks()
+        {
+#if BENCHMARKS_HAS_TSC
+            unsigned int aux;
+            _mm_lfence();
+            uint64_t ticks = __rdtscp(&aux);
+            _mm_lfence();
+            return ticks;
+#else
+            return 0;
+#endif
+        }
+
+    private:
+        static Calibration& GetCalibration()
+        {
+            static Calibration c;
+            return c;
+        }
+    };
+
+}
+
+#endif
@@ -2,17 +2,17 @@
 
 from collections import defaultdict, namedtuple
 
+from benchmarks_common import BenchmarksServer, ParallelRunner, make_slots, matches_any
+
 import argparse
 import colorama
 import copy
 import json
 import os
-import subprocess
 import sys
-import traceback
 
 
-ResultEntry = namedtuple("ResultEntry", "current, reference, error")
+ResultEntry = namedtuple("ResultEntry", "metrics, passes, error")
 
 
 def eprint(msg):
@@ -44,7 +44,13 @@ def main():
     parser.add_argument('--env-update', default='{}', help='joint-benchmarks executable environment variables update')
     parser.add_argument('--reference-env-update', default='{}', help='joint-benchmarks reference executable environment variables update')
     parser.add_argument('--benchmarks', help='benchmarks.json file', required=True)
-    parser.add_argument('--num-passes', help='number of joint-benchmarks passes required to measure performance', type=int, default=1)
+    parser.add_argument('--num-passes', help='minimal number of joint-benchmarks passes required to measure performance', type=int, default=5)
+    parser.add_argument('--max-passes', help='maximal number of passes for benchmarks without a significant verdict', type=int, default=20)
+    parser.add_argument('--alpha', help='significance level of the comparison', type=float, default=0.05)
+    parser.add_argument('--min-effect', help='smallest change in percent that is reported', type=float, default=3)
+    parser.add_argument('-j', '--jobs', type=int, default=1, help='number of benchmarks to run concurrently, each on its own core')
+    parser.add_argument('--memory-heavy', nargs='*', default=[], help='benchmark patterns that get a whole L3/NUMA domain instead of a core')
+    parser.add_argument('--isolation-check', type=float, default=0.1, help='fraction of the benchmarks to repeat in isolation to detect interference')
     args = parser.parse_args()
 
     env = copy.deepcopy(os.environ)
@@ -57,61 +63,80 @@ def main():
     with open(args.benchmarks) as benchmarks_file:
         benchmarks = json.loads(benchmarks_file.read())
 
-    result = defaultdict(lambda: {})
+    def start_servers(slot):
+        return dict(current=BenchmarksServer(args.executable, env=env, extra_args=slot.server_args()),
+                    reference=BenchmarksServer(args.reference_executable, env=reference_env, extra_args=slot.server_args()))
+
+    # Verdicts are checked when the number of passes doubles, the significance level is split between these looks
+    looks = [max(1, args.num_passes)]
+    while looks[-1] * 2 < args.max_passes:
+        looks.append(looks[-1] * 2)
+    if looks[-1] < args.max_passes:
+        looks.append(args.max_passes)
+    look_alpha = args.alpha / len(looks)
+
+    def run_benchmark(servers, job):
+        lang, id = job
+        params = {'lang': lang}
+        iterations_count = servers['current'].request('measureIterationsCount', id, params)['iterations_count']
+
+        results = dict(current=[], reference=[])
+        for i in range(looks[-1]):
+            for name in (['current', 'reference'] if i % 2 == 0 else ['reference', 'current']):
+                results[name].append(servers[name].request('invokeBenchmark', id, params, iterations=iterations_count))
+            if i + 1 in looks:
+                metrics = servers['current'].request('compare', id, params, alpha=look_alpha, min_effect=args.min_effect, **results)['metrics']
+                if all(m['verdict'] != 'inconclusive' for m in metrics.values()):
+                    break
 
-    has_errors = False
-    current_number = 1
-    total_count = sum(len(ids) for ids in benchmarks.values())
-    for lang in sorted(benchmarks):
-        for id in benchmarks[lang]:
-            ctx.info('{}/{}: {}, {}'.format(current_number, total_count, lang, id))
-            current_number += 1
-
-            try:
-                current_list = []
-                reference_list = []
-
-                cmd_args = ['--subtask', 'measureIterationsCount', id, 'lang:{}'.format(lang)]
-                current_iterations_count = json.loads(subprocess.check_output([args.executable] + cmd_args, env=env))['iterations_count']
-                reference_iterations_count = json.loads(subprocess.check_output([args.reference_executable] + cmd_args, env=reference_env))['iterations_count']
-
-                for i in range(args.num_passes):
-                    cmd = [args.executable, '--subtask', 'invokeBenchmark', '--iterations', str(current_iterations_count), id, 'lang:{}'.format(lang)]
-                    current_list.append(json.loads(subprocess.check_output(cmd, env=env))['times']['main'])
-                    cmd = [args.reference_executable, '--subtask', 'invokeBenchmark', '--iterations', str(current_iterations_count), id, 'lang:{}'.format(lang)]
-                    reference_list.append(json.loads(subprocess.check_output(cmd, env=reference_env))['times']['main'])
-
-                _, current, reference = min(((abs(c - r), c, r) for c, r in zip(sorted(current_list), sorted(reference_list))), key=lambda (d, c, r): d)
-                result[lang][id] = ResultEntry(reference=reference, current=current, error=None)
-            except subprocess.CalledProcessError:
-                has_errors = True
-                result[lang][id] = ResultEntry(reference=None, current=None, error=traceback.format_exc())
-
-    min_ratio, max_ratio = 1.0, 1.0
+        return ResultEntry(metrics=metrics, passes=i + 1, error=None)
+
+    def main_time(entry):
+        return entry.metrics.get('times.main', {}).get('current', 0)
+
+    runner = ParallelRunner(start_servers, run_benchmark, log=ctx.info)
+    jobs = [(lang, id) for lang in sorted(benchmarks) for id in benchmarks[lang]]
+
+    result = defaultdict(lambda: {})
+    for kind, kind_jobs in [('core', [j for j in jobs if not matches_any(j[1], args.memory_heavy)]),
+                            ('domain', [j for j in jobs if matches_any(j[1], args.memory_heavy)])]:
+        slots = make_slots(kind, args.jobs)
+        kind_results = runner.run(kind_jobs, slots)
+        if len(slots) > 1:
+            for (lang, id), concurrent, isolated in runner.check_interference(kind_results, slots[0], args.isolation_check, main_time):
+                ctx.warning('{}(lang:{}): interference detected, {} concurrently, {} in isolation'.format(id, lang, concurrent, isolated))
+        for (lang, id), entry in kind_results.items():
+            if isinstance(entry, Exception):
+                entry = ResultEntry(metrics=None, passes=0, error=str(entry))
+            result[lang][id] = entry
+
+    verdicts = defaultdict(int)
     for lang in sorted(result):
         lang_result = result[lang]
         for id in sorted(lang_result):
             entry = lang_result[id]
             if entry.error:
                 ctx.error('{}(lang:{}):\n{}'.format(id, lang, entry.error))
-            else:
-                ratio = float(entry.current) / entry.reference
-                min_ratio = min(min_ratio, ratio)
-                max_ratio = max(max_ratio, ratio)
+                continue
+
+            for metric in sorted(entry.metrics):
+                m = entry.metrics[metric]
+                verdicts[m['verdict']] += 1
 
                 def msg(text):
-                    return '{}(lang:{}): {} {} -> {} ({:.2f})'.format(id, lang, text, entry.reference, entry.current, ratio)
+                    return '{}(lang:{}) {}: {} {} -> {} ({:+.1%}, ci [{:+.1%}, {:+.1%}], p {:.3g}, {} passes)'.format(
+                        id, lang, metric, text, m['reference'], m['current'], m['effect'], m['effect_ci_low'], m['effect_ci_high'], m['adjusted_p_value'], entry.passes)
 
-                if entry.current < entry.reference * 0.8:
-                    ctx.ok(msg('FASTER'))
-                elif entry.current < entry.reference * 1.1:
+                if m['verdict'] == 'improvement':
+                    ctx.ok(msg('FASTER' if metric.startswith('times.') else 'LESS MEMORY'))
+                elif m['verdict'] == 'no_change':
                     ctx.info(msg('OK'))
-                elif entry.current < entry.reference * 1.25:
-                    ctx.warning(msg('A BIT SLOWER'))
+                elif m['verdict'] == 'inconclusive':
+                    ctx.warning(msg('INCONCLUSIVE'))
                 else:
-                    ctx.error(msg('SLOWER'))
+                    ctx.error(msg('SLOWER' if metric.startswith('times.') else 'MORE MEMORY'))
 
-    ctx.info('min ratio: {:.2f}, max ratio: {:.2f}'.format(min_ratio, max_ratio))
+    ctx.info(', '.join('{}: {}'.format(v, verdicts[v]) for v in sorted(verdicts)))
     if ctx.num_errors:
         ctx.error('{} errors!'.format(ctx.num_errors))
 
@@ -4,10 +4,10 @@ from copy import copy
 from math import log10
 from pyparsing import CharsNotIn, Group, Optional, Suppress, Word, ZeroOrMore, alphanums, alphas, delimitedList, originalTextFor
 
+from benchmarks_common import BenchmarksServer, ParallelRunner, make_slots, matches_any
+
 import argparse
 import contextlib
-import json
-import subprocess
 import sys
 
 
@@ -46,7 +46,11 @@ def main():
     parser.add_argument('-t', '--template', help='Template file', required=True)
     parser.add_argument('-o', '--output', default='-', help='Output file (use -o- for stdin)')
     parser.add_argument('-v', '--verbosity', type=int, default=1, help='Verbosity in range [0..4]')
-    parser.add_argument('-c', '--count', type=int, default=1, help='Measurements count')
+    parser.add_argument('-c', '--count', type=int, default=1, help='Number of samples per measurement')
+    parser.add_argument('--calibration-cache', help='File to cache the calibrated iterations counts in')
+    parser.add_argument('-j', '--jobs', type=int, default=1, help='Number of measurements to run concurrently, each on its own core')
+    parser.add_argument('--memory-heavy', nargs='*', default=[], help='Benchmark patterns that get a whole L3/NUMA domain instead of a core')
+    parser.add_argument('--isolation-check', type=float, default=0.1, help='Fraction of the measurements to repeat in isolation to detect interference')
     args = parser.parse_args()
 
     with open(args.template) as template_file:
@@ -61,19 +65,31 @@ def main():
                 measurement = entry['macro']['measurement']
                 measurements[make_measurement_key(measurement)] = measurement
 
-        measurement_results = dict()
-        for i, measurement_key in enumerate(sorted(measurements)):
-            progress_format = '{{: >{}}}/{{}}: {{}}\n'.format(int(log10(len(measurements))) + 1)
-            sys.stderr.write(progress_format.format(i + 1, len(measurements), measurement_key))
+        def start_servers(slot):
+            return dict(server=BenchmarksServer(args.executable, args.verbosity, extra_args=slot.server_args() + (['--calibration-cache', args.calibration_cache] if args.calibration_cache else [])))
+
+        def run_measurement(servers, measurement_key):
             measurement = measurements[measurement_key]
-            cmd_args = ['--verbosity', str(args.verbosity), measurement['benchmark']] + ['{}:{}'.format(param['name'], param['value']) for param in measurement.get('params', [])]
+            params = dict((param['name'], param['value']) for param in measurement.get('params', []))
+            return servers['server'].request('run', measurement['benchmark'], params, samples=args.count)
 
-            cmd = [args.executable, '--subtask', 'measureIterationsCount'] + cmd_args
-            iterations_count = json.loads(subprocess.check_output(cmd))['iterations_count']
+        def measurement_value(result):
+            return sum(result['times'].values())
 
-            cmd = [args.executable, '--subtask', 'invokeBenchmark', '--iterations', str(iterations_count)] + cmd_args
-            value = min(json.loads(subprocess.check_output(cmd)) for j in xrange(args.count))
-            measurement_results[measurement_key] = value
+        runner = ParallelRunner(start_servers, run_measurement)
+        measurement_results = dict()
+        for kind, keys in [('core', [k for k in sorted(measurements) if not matches_any(measurements[k]['benchmark'], args.memory_heavy)]),
+                           ('domain', [k for k in sorted(measurements) if matches_any(measurements[k]['benchmark'], args.memory_heavy)])]:
+            slots = make_slots(kind, args.jobs)
+            results = runner.run(keys, slots)
+            if len(slots) > 1:
+                for key, concurrent, isolated in runner.check_interference(results, slots[0], args.isolation_check, measurement_value):
+                    sys.stderr.write('Interference detected for {}: {} concurrently, {} in isolation\n'.format(key, concurrent, isolated))
+            measurement_results.update(results)
+
+        for key, result in measurement_results.items():
+            if isinstance(result, Exception):
+                raise result
 
         with open_output(args.output) as out:
             for entry in template['template']:
@@ -84,6 +100,7 @@ def main():
                     result = measurement_results[make_measurement_key(measurement)]
                     result_dict = copy(result['memory'])
                     result_dict.update(result['times'])
+                    result_dict.update(result.get('metrics', {}))
                     value = result_dict[measurement['local_id']]
                     out_format = '{{:.{}f}}'.format(max(0, 1 - int(log10(value))))
                     out.write(out_format.format(value))
@@ -0,0 +1,213 @@
+from collections import namedtuple
+from fnmatch import fnmatchcase
+
+import glob
+import json
+import os
+import random
+import subprocess
+import sys
+import threading
+
+try:
+    from queue import Queue, Empty
+except ImportError:
+    from Queue import Queue, Empty
+
+
+class BenchmarksServer:
+    def __init__(self, executable, verbosity=None, env=None, extra_args=()):
+        cmd = [executable, '--subtask', 'serve']
+        if verbosity is not None:
+            cmd += ['--verbosity', str(verbosity)]
+        cmd += list(extra_args)
+        self.process = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, env=env, universal_newlines=True)
+
+    def request(self, subtask, benchmark, params, **kwargs):
+        request = dict(subtask=subtask, benchmark=benchmark, params=params)
+        request.update(kwargs)
+        self.process.stdin.write(json.dumps(request) + '\n')
+        self.process.stdin.flush()
+        line = self.process.stdout.readline()
+        if not line:
+            raise RuntimeError('Benchmarks server terminated unexpectedly')
+        response = json.loads(line)
+        if 'error' in response:
+            raise RuntimeError('{}: {}'.format(benchmark, response['error']))
+        return response
+
+    def close(self):
+        self.process.stdin.close()
+        self.process.wait()
+
+
+class CpuSlot(namedtuple('CpuSlot', 'cpus numa_node')):
+    def server_args(self):
+        args = []
+        if self.cpus:
+            args += ['--cpus', ','.join(str(cpu) for cpu in self.cpus)]
+        if self.numa_node is not None:
+            args += ['--numa-node', str(self.numa_node)]
+        return args
+
+
+def _read_sysfs(path, default=None):
+    try:
+        with open(path) as f:
+            return f.read().strip()
+    except (IOError, OSError):
+        return default
+
+
+def _parse_cpu_list(cpu_list):
+    result = []
+    for cpu_range in cpu_list.split(','):
+        if '-' in cpu_range:
+            first, last = cpu_range.split('-')
+            result.extend(range(int(first), int(last) + 1))
+        elif cpu_range:
+            result.append(int(cpu_range))
+    return result
+
+
+def _cpu_topology():
+    ''' Returns a list of (cpu, core, l3 domain, numa node) for every online CPU '''
+    online = _read_sysfs('/sys/devices/system/cpu/online')
+    cpus = _parse_cpu_list(online) if online else list(range(len(os.sched_getaffinity(0)) if hasattr(os, 'sched_getaffinity') else 1))
+
+    numa_nodes = {}
+    for node_dir in glob.glob('/sys/devices/system/node/node[0-9]*'):
+        node = int(os.path.basename(node_dir)[4:])
+        for cpu in _parse_cpu_list(_read_sysfs(os.path.join(node_dir, 'cpulist'), '')):
+            numa_nodes[cpu] = node
+
+    result = []
+    for cpu in cpus:
+        cpu_dir = '/sys/devices/system/cpu/cpu{}'.format(cpu)
+        package = _read_sysfs(os.path.join(cpu_dir, 'topology/physical_package_id'), '0')
+        core = (package, _read_sysfs(os.path.join(cpu_dir, 'topology/core_id'), str(cpu)))
+        l3 = _read_sysfs(os.path.join(cpu_dir, 'cache/index3/shared_cpu_list')) or 'package{}'.format(package)
+        result.append((cpu, core, l3, numa_nodes.get(cpu)))
+    return result
+
+
+def core_slots():
+    ''' One slot per physical core, pinned to the first hardware thread of the core '''
+    slots, seen_cores = [], set()
+    for cpu, core, _, numa_node in _cpu_topology():
+        if core not in seen_cores:
+            seen_cores.add(core)
+            slots.append(CpuSlot(cpus=[cpu], numa_node=numa_node))
+    return slots
+
+
+def domain_slots():
+    ''' One slot per L3 cache domain, using one hardware thread of every core in it '''
+    domains, seen_cores = {}, set()
+    for cpu, core, l3, numa_node in _cpu_topology():
+        if core not in seen_cores:
+            seen_cores.add(core)
+            domains.setdefault(l3, CpuSlot(cpus=[], numa_node=numa_node)).cpus.append(cpu)
+    return [domains[k] for k in sorted(domains, key=lambda k: domains[k].cpus[0])]
+
+
+def make_slots(kind, num_jobs):
+    ''' Returns up to num_jobs disjoint slots, or a single unpinned slot when running sequentially '''
+    if num_jobs <= 1:
+        return [CpuSlot(cpus=None, numa_node=None)]
+    slots = core_slots() if kind == 'core' else domain_slots()
+    return slots[:num_jobs] or [CpuSlot(cpus=None, numa_node=None)]
+
+
+def matches_any(name, patterns):
+    return any(fnmatchcase(name, p) for p in patterns)
+
+
+class ParallelRunner:
+    ''' Runs independent jobs concurrently, one job per CPU slot at a time.
+
+        start_servers(slot) returns the servers a job needs (pinned to the slot), run_job(servers, job) performs a
+        measurement and returns its result. Failed jobs get the exception as their result and the slot restarts its
+        servers before its next job.
+    '''
+
+    def __init__(self, start_servers, run_job, log=None):
+        self.start_servers = start_servers
+        self.run_job = run_job
+        self.log = log or (lambda msg: sys.stderr.write(msg + '\n'))
+        self.log_lock = threading.Lock()
+
+    def run(self, jobs, slots):
+        jobs_queue = Queue()
+        for i, job in enumerate(jobs):
+            jobs_queue.put((i, job))
+
+        results = {}
+        worker_errors = []
+        results_lock = threading.Lock()
+
+        def worker(slot):
+            servers = None
+            try:
+                while True:
+                    try:
+                        i, job = jobs_queue.get_nowait()
+                    except Empty:
+                        return
+                    with self.log_lock:
+                        self.log('{}/{}: {}{}'.format(i + 1, len(jobs), job, ' (cpus: {})'.format(slot.cpus) if slot.cpus else ''))
+                    try:
+                        if servers is None:
+                            servers = self.start_servers(slot)
+                        result = self.run_job(servers, job)
+                    except Exception as ex:
+                        result = ex
+                        # The servers may have crashed, the next job of the slot gets fresh ones
+                        self._close_servers(servers)
+                        servers = None
+                    with results_lock:
+                        results[job] = result
+            except Exception as ex:
+                with results_lock:
+                    worker_errors.append(ex)
+            finally:
+                self._close_servers(servers)
+
+        threads = [threading.Thread(target=worker, args=(slot,)) for slot in slots[:max(1, len(jobs))]]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        if worker_errors:
+            raise RuntimeError('{} worker(s) failed: {}'.format(len(worker_errors), '; '.join(str(e) for e in worker_errors)))
+        return results
+
+    def _close_servers(self, servers):
+        for server in (servers or {}).values():
+            try:
+                server.close()
+            except Exception as ex:
+                with self.log_lock:
+                    self.log('Could not close a benchmarks server: {}'.format(ex))
+
+    def check_interference(self, results, slot, fraction, get_value, tolerance=0.05, seed=0):
+        ''' Re-measures a sample of the jobs alone on the machine, replaces the sampled results with the isolated ones
+            and returns a list of (job, concurrent value, isolated value) for the jobs that differ more than tolerance.
+        '''
+        candidates = sorted(job for job, r in results.items() if not isinstance(r, Exception))
+        if not candidates or fraction <= 0:
+            return []
+
+        sample = random.Random(seed).sample(candidates, max(1, int(len(candidates) * fraction)))
+        isolated = self.run(sample, [slot])
+
+        interfered = []
+        for job in sample:
+            if job not in isolated or isinstance(isolated[job], Exception):
+                continue
+            concurrent_value, isolated_value = get_value(results[job]), get_value(isolated[job])
+            if isolated_value and abs(concurrent_value / isolated_value - 1) > tolerance:
+                interfered.append((job, concurrent_value, isolated_value))
+            results[job] = isolated[job]
+        return interfered
@@ -0,0 +1,121 @@
+#ifndef BENCHMARKS_SUITES_CONCURRENCY_COUNTERS_HPP
+#define BENCHMARKS_SUITES_CONCURRENCY_COUNTERS_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/BenchmarkClass.hpp>
+#include <benchmarks/BenchmarkContext.hpp>
+#include <benchmarks/utils/ThreadCounts.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    // All the threads increment the same counter
+    struct SharedCounterDesc
+    {
+        struct Slot
+        { std::atomic<int64_t> value; };
+
+        static size_t GetSlotIndex(int threadIndex) { return 0; }
+        static std::string GetName() { return "shared"; }
+    };
+
+    // Every thread has its own counter, but the counters share cache lines
+    struct PackedCountersDesc
+    {
+        struct Slot
+        { std::atomic<int64_t> value; };
+
+        static size_t GetSlotIndex(int threadIndex) { return threadIndex; }
+        static std::string GetName() { return "packed"; }
+    };
+
+    // Every thread has its own counter, the padding keeps the neighbouring counters on different cache lines
+    // regardless of the alignment of the array
+    struct PaddedCountersDesc
+    {
+        static const size_t CacheLineSize = 64;
+
+        struct Slot
+        {
+            char                    padding[CacheLineSize];
+            std::atomic<int64_t>    value;
+        };
+
+        static size_t GetSlotIndex(int threadIndex) { return threadIndex; }
+        static std::string GetName() { return "padded"; }
+    };
+
+
+    template < typename CountersDesc_ >
+    class CountersBenchmarks : public BenchmarksClass
+    {
+        using Slot = typename CountersDesc_::Slot;
+
+    public:
+        CountersBenchmarks()
+            : BenchmarksClass("counters")
+        {
+            AddBenchmark<ThreadCounts>("fetchAdd", &CountersBenchmarks::FetchAdd, {"threads"}, {{"threads", "1,2,...,ncores"}});
+            AddBenchmark<ThreadCounts>("loadStore", &CountersBenchmarks::LoadStore, {"threads"}, {{"threads", "1,2,...,ncores"}});
+        }
+
+    private:
+        static void FetchAdd(BenchmarkContext& context, const ThreadCounts& threads)
+        {
+            const auto n = context.GetIterationsCount();
+            std::vector<Slot> slots(GetSlotsCount(threads));
+            for (auto& s : slots)
+                s.value.store(0);
+
+            context.ProfileScaling("fetch_add", n, threads.Get(), [&](int threadIndex)
+                {
+                    auto& value = slots[CountersDesc_::GetSlotIndex(threadIndex)].value;
+                    for (int64_t i = 0; i < n; ++i)
+                        value.fetch_add(1, std::memory_order_relaxed);
+                });
+        }
+
+        // Plain increments that need no locked instructions, the cost comes only from the cache line transfers
+        static void LoadStore(BenchmarkContext& context, const ThreadCounts& threads)
+        {
+            const auto n = context.GetIterationsCount();
+            std::vector<Slot> slots(GetSlotsCount(threads));
+            for (auto& s : slots)
+                s.value.store(0);
+
+            context.ProfileScaling("load_store", n, threads.Get(), [&](int threadIndex)
+                {
+                    auto& value = slots[CountersDesc_::GetSlotIndex(threadIndex)].value;
+                    for (int64_t i = 0; i < n; ++i)
+                        value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                });
+        }
+
+        static size_t GetSlotsCount(const ThreadCounts& threads)
+        {
+            const auto& counts = threads.Get();
+            return counts.empty() ? 1 : (size_t)*std::max_element(counts.begin(), counts.end());
+        }
+    };
+
+}
+
+#endif
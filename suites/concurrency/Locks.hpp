@@ -0,0 +1,175 @@
+#ifndef BENCHMARKS_SUITES_CONCURRENCY_LOCKS_HPP
+#define BENCHMARKS_SUITES_CONCURRENCY_LOCKS_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/BenchmarkClass.hpp>
+#include <benchmarks/BenchmarkContext.hpp>
+#include <benchmarks/utils/DoNotOptimize.hpp>
+#include <benchmarks/utils/SpinBarrier.hpp>
+#include <benchmarks/utils/ThreadCounts.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <stdint.h>
+
+
+namespace suites
+{
+    namespace concurrency
+    {
+
+        // Test and test-and-set lock, yields after spinning for a while so that oversubscribed runs still finish
+        class SpinLock
+        {
+            static const int MaxSpinsBeforeYield = 4096;
+
+        private:
+            std::atomic<bool>   _locked;
+
+        public:
+            SpinLock() : _locked(false) { }
+
+            SpinLock(const SpinLock&) = delete;
+            SpinLock& operator = (const SpinLock&) = delete;
+
+            void lock()
+            {
+                while (_locked.exchange(true, std::memory_order_acquire))
+                {
+                    for (int i = 0; _locked.load(std::memory_order_relaxed); ++i)
+                    {
+                        if (i < MaxSpinsBeforeYield)
+                            benchmarks::CpuRelax();
+                        else
+                            std::this_thread::yield();
+                    }
+                }
+            }
+
+            void unlock()
+            { _locked.store(false, std::memory_order_release); }
+        };
+
+
+        // FIFO spinlock, the waiters are served in the order of arrival
+        class TicketLock
+        {
+            static const int MaxSpinsBeforeYield = 4096;
+
+        private:
+            std::atomic<uint32_t>   _next;
+            std::atomic<uint32_t>   _serving;
+
+        public:
+            TicketLock() : _next(0), _serving(0) { }
+
+            TicketLock(const TicketLock&) = delete;
+            TicketLock& operator = (const TicketLock&) = delete;
+
+            void lock()
+            {
+                uint32_t ticket = _next.fetch_add(1, std::memory_order_relaxed);
+                for (int i = 0; _serving.load(std::memory_order_acquire) != ticket; ++i)
+                {
+                    if (i < MaxSpinsBeforeYield)
+                        benchmarks::CpuRelax();
+                    else
+                        std::this_thread::yield();
+                }
+            }
+
+            void unlock()
+            { _serving.store(_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+        };
+
+    }
+}
+
+
+namespace benchmarks
+{
+
+    struct StdMutexDesc
+    {
+        using Lock = std::mutex;
+        static std::string GetName() { return "std_mutex"; }
+    };
+
+    struct SpinLockDesc
+    {
+        using Lock = suites::concurrency::SpinLock;
+        static std::string GetName() { return "spinlock"; }
+    };
+
+    struct TicketLockDesc
+    {
+        using Lock = suites::concurrency::TicketLock;
+        static std::string GetName() { return "ticket_lock"; }
+    };
+
+
+    template < typename LockDesc_ >
+    class LocksBenchmarks : public BenchmarksClass
+    {
+        using Lock = typename LockDesc_::Lock;
+
+    public:
+        LocksBenchmarks()
+            : BenchmarksClass("locks")
+        {
+            AddBenchmark<ThreadCounts>("lockUnlock", &LocksBenchmarks::LockUnlock, {"threads"}, {{"threads", "1,2,...,ncores"}});
+            AddBenchmark<ThreadCounts>("criticalSection", &LocksBenchmarks::CriticalSection, {"threads"}, {{"threads", "1,2,...,ncores"}});
+        }
+
+    private:
+        static void LockUnlock(BenchmarkContext& context, const ThreadCounts& threads)
+        {
+            const auto n = context.GetIterationsCount();
+            Lock lock;
+            int64_t counter = 0;
+            context.ProfileScaling("lock_unlock", n, threads.Get(), [&](int)
+                {
+                    for (int64_t i = 0; i < n; ++i)
+                    {
+                        std::lock_guard<Lock> l(lock);
+                        ++counter;
+                    }
+                });
+            DoNotOptimize(counter);
+        }
+
+        // Some work under the lock, so the waiters have a chance to queue up
+        static void CriticalSection(BenchmarkContext& context, const ThreadCounts& threads)
+        {
+            const auto n = context.GetIterationsCount();
+            Lock lock;
+            uint64_t state[8] = { };
+            context.ProfileScaling("critical_section", n, threads.Get(), [&](int threadIndex)
+                {
+                    for (int64_t i = 0; i < n; ++i)
+                    {
+                        std::lock_guard<Lock> l(lock);
+                        for (auto& s : state)
+                            s = s * 6364136223846793005ULL + threadIndex;
+                    }
+                });
+            DoNotOptimize(state);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef BENCHMARKS_SUITES_CONCURRENCY_QUEUES_HPP
+#define BENCHMARKS_SUITES_CONCURRENCY_QUEUES_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/BenchmarkClass.hpp>
+#include <benchmarks/BenchmarkContext.hpp>
+#include <benchmarks/utils/DoNotOptimize.hpp>
+#include <benchmarks/utils/SpinBarrier.hpp>
+#include <benchmarks/utils/ThreadCounts.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace suites
+{
+    namespace concurrency
+    {
+
+        inline size_t RoundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+                result *= 2;
+            return result;
+        }
+
+
+        class MutexQueue
+        {
+        private:
+            const size_t            _capacity;
+            std::mutex              _mutex;
+            std::deque<int64_t>     _queue;
+
+        public:
+            explicit MutexQueue(size_t capacity) : _capacity(capacity) { }
+
+            MutexQueue(const MutexQueue&) = delete;
+            MutexQueue& operator = (const MutexQueue&) = delete;
+
+            bool TryPush(int64_t value)
+            {
+                std::lock_guard<std::mutex> l(_mutex);
+                if (_queue.size() >= _capacity)
+                    return false;
+                _queue.push_back(value);
+                return true;
+            }
+
+            bool TryPop(int64_t& value)
+            {
+                std::lock_guard<std::mutex> l(_mutex);
+                if (_queue.empty())
+                    return false;
+                value = _queue.front();
+                _queue.pop_front();
+                return true;
+            }
+        };
+
+
+        // Single producer, single consumer ring buffer, the capacity is rounded up to a power of two
+        class SpscRingBuffer
+        {
+            static const size_t CacheLineSize = 64;
+
+        private:
+            const size_t                    _mask;
+            std::unique_ptr<int64_t[]>      _buffer;
+            char                            _padding0[CacheLineSize];
+            std::atomic<size_t>             _head;
+            char                            _padding1[CacheLineSize];
+            std::atomic<size_t>             _tail;
+            char                            _padding2[CacheLineSize];
+
+        public:
+            explicit SpscRingBuffer(size_t capacity)
+                : _mask(RoundUpToPowerOfTwo(capacity) - 1), _buffer(new int64_t[_mask + 1]), _head(0), _tail(0)
+            { }
+
+            SpscRingBuffer(const SpscRingBuffer&) = delete;
+            SpscRingBuffer& operator = (const SpscRingBuffer&) = delete;
+
+            bool TryPush(int64_t value)
+            {
+                size_t tail = _tail.load(std::memory_order_relaxed);
+                if (tail - _head.load(std::memory_order_acquire) > _mask)
+                    return false;
+                _buffer[tail & _mask] = value;
+                _tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool TryPop(int64_t& value)
+            {
+                size_t head = _head.load(std::memory_order_relaxed);
+                if (head == _tail.load(std::memory_order_acquire))
+                    return false;
+                value = _buffer[head & _mask];
+                _head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+        };
+
+
+        // Bounded multi-producer, multi-consumer queue, every cell has a sequence number that tells
+        // whether it is ready to be written or read on the current lap (D. Vyukov's algorithm)
+        class MpmcRingBuffer
+        {
+            static const size_t CacheLineSize = 64;
+
+            struct Cell
+            {
+                std::atomic<size_t>     sequence;
+                int64_t                 value;
+            };
+
+        private:
+            const size_t                _mask;
+            std::unique_ptr<Cell[]>     _cells;
+            char                        _padding0[CacheLineSize];
+            std::atomic<size_t>         _enqueuePos;
+            char                        _padding1[CacheLineSize];
+            std::atomic<size_t>         _dequeuePos;
+            char                        _padding2[CacheLineSize];
+
+        public:
+            explicit MpmcRingBuffer(size_t capacity)
+                : _mask(RoundUpToPowerOfTwo(capacity) - 1), _cells(new Cell[_mask + 1]), _enqueuePos(0), _dequeuePos(0)
+            {
+                for (size_t i = 0; i <= _mask; ++i)
+                    _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+            MpmcRingBuffer& operator = (const MpmcRingBuffer&) = delete;
+
+            bool TryPush(int64_t value)
+            {
+                size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    Cell& cell = _cells[pos & _mask];
+                    auto diff = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+                    if (diff == 0)
+                    {
+                        if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            cell.value = value;
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            bool TryPop(int64_t& value)
+            {
+                size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    Cell& cell = _cells[pos & _mask];
+                    auto diff = (intptr_t)cell.sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+                    if (diff == 0)
+                    {
+                        if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            value = cell.value;
+                            cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+    }
+}
+
+
+namespace benchmarks
+{
+
+    struct MutexQueueDesc
+    {
+        using Queue = suites::concurrency::MutexQueue;
+        static const bool MultiProducer = true;
+        static std::string GetName() { return "mutex_queue"; }
+    };
+
+    struct SpscRingBufferDesc
+    {
+        using Queue = suites::concurrency::SpscRingBuffer;
+        static const bool MultiProducer = false;
+        static std::string GetName() { return "spsc_ring"; }
+    };
+
+    struct MpmcRingBufferDesc
+    {
+        using Queue = suites::concurrency::MpmcRingBuffer;
+        static const bool MultiProducer = true;
+        static std::string GetName() { return "mpmc_ring"; }
+    };
+
+
+    template < typename QueueDesc_ >
+    class QueuesBenchmarks : public BenchmarksClass
+    {
+        using Queue = typename QueueDesc_::Queue;
+
+        static const int MaxSpinsBeforeYield = 4096;
+
+    public:
+        QueuesBenchmarks()
+            : BenchmarksClass("queues")
+        {
+            AddBenchmark<int64_t>("spsc", &QueuesBenchmarks::Spsc, {"capacity"}, {{"capacity", "1024"}});
+            if (QueueDesc_::MultiProducer)
+                AddBenchmark<int64_t, ThreadCounts>("mpmc", &QueuesBenchmarks::Mpmc, {"capacity", "threads"}, {{"capacity", "1024"}, {"threads", "2,4,...,ncores"}});
+        }
+
+    private:
+        static void Spsc(BenchmarkContext& context, int64_t capacity)
+        {
+            const auto n = context.GetIterationsCount();
+            Queue queue((size_t)capacity);
+            context.ProfileConcurrentTotal("transfer", n, 2, [&](int threadIndex)
+                {
+                    if (threadIndex == 0)
+                        Produce(queue, n);
+                    else
+                        Consume(queue, n);
+                });
+        }
+
+        // Half of the threads push, the other half pop, at least one of each. The n items are split between the
+        // producers and between the consumers, so every thread count transfers the same number of items.
+        static void Mpmc(BenchmarkContext& context, int64_t capacity, const ThreadCounts& threads)
+        {
+            const auto n = context.GetIterationsCount();
+            Queue queue((size_t)capacity);
+
+            std::vector<int> thread_counts;
+            for (int num_threads : threads.Get())
+                if (std::find(thread_counts.begin(), thread_counts.end(), std::max(2, num_threads)) == thread_counts.end())
+                    thread_counts.push_back(std::max(2, num_threads));
+
+            context.ProfileScalingTotal("transfer", n, thread_counts, [&](int threadIndex, int numThreads)
+                {
+                    int num_producers = numThreads / 2;
+                    if (threadIndex < num_producers)
+                        Produce(queue, GetShare(n, num_producers, threadIndex));
+                    else
+                        Consume(queue, GetShare(n, numThreads - num_producers, threadIndex - num_producers));
+                });
+        }
+
+        static int64_t GetShare(int64_t total, int numParts, int index)
+        { return total / numParts + (index < total % numParts ? 1 : 0); }
+
+        static void Produce(Queue& queue, int64_t count)
+        {
+            for (int64_t i = 0; i < count; ++i)
+                for (int spins = 0; !queue.TryPush(i); ++spins)
+                    Wait(spins);
+        }
+
+        static void Consume(Queue& queue, int64_t count)
+        {
+            int64_t value = 0;
+            for (int64_t i = 0; i < count; ++i)
+            {
+                for (int spins = 0; !queue.TryPop(value); ++spins)
+                    Wait(spins);
+                DoNotOptimize(value);
+            }
+        }
+
+        static void Wait(int spins)
+        {
+            if (spins < MaxSpinsBeforeYield)
+                CpuRelax();
+            else
+                std::this_thread::yield();
+        }
+    };
+
+}
+
+#endif
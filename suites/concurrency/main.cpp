@@ -0,0 +1,26 @@
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include <benchmarks/BenchmarkApp.hpp>
+
+#include <suites/concurrency/Counters.hpp>
+#include <suites/concurrency/Locks.hpp>
+#include <suites/concurrency/Queues.hpp>
+
+
+int main(int argc, const char* argv[])
+{
+    using namespace benchmarks;
+
+    BenchmarkSuite suite;
+    suite.RegisterBenchmarks<LocksBenchmarks, StdMutexDesc, SpinLockDesc, TicketLockDesc>("locks");
+    suite.RegisterBenchmarks<CountersBenchmarks, SharedCounterDesc, PackedCountersDesc, PaddedCountersDesc>("counters");
+    suite.RegisterBenchmarks<QueuesBenchmarks, MutexQueueDesc, SpscRingBufferDesc, MpmcRingBufferDesc>("queues");
+    return RunBenchmarkApp(suite, argc, argv);
+}
@@ -0,0 +1,198 @@
+#ifndef BENCHMARKS_SUITES_CONTAINERS_CONTAINERSBENCHMARKS_HPP
+#define BENCHMARKS_SUITES_CONTAINERS_CONTAINERSBENCHMARKS_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <benchmarks/BenchmarkClass.hpp>
+#include <benchmarks/BenchmarkContext.hpp>
+#include <benchmarks/utils/DoNotOptimize.hpp>
+
+#include <suites/containers/FlatMap.hpp>
+#include <suites/containers/KeyDistribution.hpp>
+#include <suites/containers/OpenAddressingMap.hpp>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace benchmarks
+{
+
+    template < typename Map_ >
+    struct StdMapOps
+    {
+        using Map = Map_;
+
+        static void Insert(Map& m, int64_t key, int64_t value) { m.insert(std::make_pair(key, value)); }
+        static void Erase(Map& m, int64_t key) { m.erase(key); }
+
+        static const int64_t* Find(const Map& m, int64_t key)
+        {
+            auto it = m.find(key);
+            return it == m.end() ? nullptr : &it->second;
+        }
+
+        template < typename Functor_ >
+        static void ForEach(const Map& m, const Functor_& func)
+        {
+            for (const auto& p : m)
+                func(p.first, p.second);
+        }
+    };
+
+    template < typename Map_ >
+    struct MemberMapOps
+    {
+        using Map = Map_;
+
+        static void Insert(Map& m, int64_t key, int64_t value) { m.Insert(key, value); }
+        static void Erase(Map& m, int64_t key) { m.Erase(key); }
+        static const int64_t* Find(const Map& m, int64_t key) { return m.Find(key); }
+
+        template < typename Functor_ >
+        static void ForEach(const Map& m, const Functor_& func)
+        { m.ForEach(func); }
+    };
+
+
+    struct StdMapDesc : public StdMapOps<std::map<int64_t, int64_t>>
+    { static std::string GetName() { return "std_map"; } };
+
+    struct StdUnorderedMapDesc : public StdMapOps<std::unordered_map<int64_t, int64_t>>
+    { static std::string GetName() { return "std_unordered_map"; } };
+
+    struct FlatMapDesc : public MemberMapOps<suites::containers::FlatMap>
+    { static std::string GetName() { return "flat_map"; } };
+
+    struct OpenAddressingMapDesc : public MemberMapOps<suites::containers::OpenAddressingMap>
+    { static std::string GetName() { return "open_addressing_map"; } };
+
+
+    template < typename MapDesc_ >
+    class ContainersBenchmarks : public BenchmarksClass
+    {
+        using Map = typename MapDesc_::Map;
+        using KeyDistribution = suites::containers::KeyDistribution;
+
+    public:
+        ContainersBenchmarks()
+            : BenchmarksClass("containers")
+        {
+            AddBenchmark<KeyDistribution, int64_t>("insert", &ContainersBenchmarks::Insert, {"keys", "size"}, {{"keys", "uniform"}, {"size", "10000"}});
+            AddBenchmark<KeyDistribution, int64_t>("lookupHit", &ContainersBenchmarks::LookupHit, {"keys", "size"}, {{"keys", "uniform"}, {"size", "10000"}});
+            AddBenchmark<KeyDistribution, int64_t>("lookupMiss", &ContainersBenchmarks::LookupMiss, {"keys", "size"}, {{"keys", "uniform"}, {"size", "10000"}});
+            AddBenchmark<KeyDistribution, int64_t>("iterate", &ContainersBenchmarks::Iterate, {"keys", "size"}, {{"keys", "uniform"}, {"size", "10000"}});
+            AddBenchmark<KeyDistribution, int64_t>("erase", &ContainersBenchmarks::Erase, {"keys", "size"}, {{"keys", "uniform"}, {"size", "10000"}});
+        }
+
+    private:
+        // The operations are spread over several containers of the given size, so the cost of an operation does not
+        // depend on the iterations count, while the memory still grows with it
+        static void Insert(BenchmarkContext& context, const KeyDistribution& keys, int64_t size)
+        {
+            CheckSize(size);
+            const auto n = context.GetIterationsCount();
+            std::vector<Map> maps((size_t)((n + size - 1) / size));
+            context.Profile("insert", n, [&]
+                {
+                    for (int64_t i = 0; i < n; ++i)
+                        MapDesc_::Insert(maps[i / size], keys.KeyAt(i % size), i);
+                });
+            context.MeasureMemory("element", n);
+        }
+
+        static void LookupHit(BenchmarkContext& context, const KeyDistribution& keys, int64_t size)
+        { Lookup(context, "lookup_hit", keys, size, 0); }
+
+        static void LookupMiss(BenchmarkContext& context, const KeyDistribution& keys, int64_t size)
+        { Lookup(context, "lookup_miss", keys, size, size); }
+
+        static void Iterate(BenchmarkContext& context, const KeyDistribution& keys, int64_t size)
+        {
+            CheckSize(size);
+            const auto num_passes = std::max<int64_t>(1, context.GetIterationsCount() / size);
+            Map m;
+            Fill(m, keys, size);
+
+            int64_t sum = 0;
+            context.Profile("iterate", num_passes * size, [&]
+                {
+                    for (int64_t i = 0; i < num_passes; ++i)
+                        MapDesc_::ForEach(m, [&](int64_t key, int64_t value) { sum += value; });
+                });
+            DoNotOptimize(sum);
+        }
+
+        static void Erase(BenchmarkContext& context, const KeyDistribution& keys, int64_t size)
+        {
+            CheckSize(size);
+            const auto n = context.GetIterationsCount();
+            std::vector<Map> maps((size_t)((n + size - 1) / size));
+            for (int64_t i = 0; i < n; ++i)
+                MapDesc_::Insert(maps[i / size], keys.KeyAt(i % size), i);
+
+            context.Profile("erase", n, [&]
+                {
+                    for (int64_t i = 0; i < n; ++i)
+                        MapDesc_::Erase(maps[i / size], keys.KeyAt(i % size));
+                });
+        }
+
+        // The access keys are generated in advance and reused cyclically, so the loop only does the lookups
+        static void Lookup(BenchmarkContext& context, const std::string& name, const KeyDistribution& keys, int64_t size, int64_t keysOffset)
+        {
+            CheckSize(size);
+            const int64_t max_access_keys = 1 << 16;
+            const auto n = context.GetIterationsCount();
+            Map m;
+            Fill(m, keys, size);
+
+            int64_t num_access_keys = 1;
+            while (num_access_keys < std::min(n, max_access_keys))
+                num_access_keys *= 2;
+
+            std::vector<int64_t> access_keys = keys.GetAccessIndices(size, num_access_keys);
+            for (auto& k : access_keys)
+                k = keys.KeyAt(k + keysOffset);
+
+            const int64_t mask = num_access_keys - 1;
+            int64_t found = 0;
+            context.Profile(name, n, [&]
+                {
+                    for (int64_t i = 0; i < n; ++i)
+                        found += (MapDesc_::Find(m, access_keys[i & mask]) != nullptr);
+                });
+            DoNotOptimize(found);
+        }
+
+        static void CheckSize(int64_t size)
+        {
+            if (size <= 0)
+                throw std::runtime_error("Invalid container size: " + std::to_string(size));
+        }
+
+        static void Fill(Map& m, const KeyDistribution& keys, int64_t size)
+        {
+            for (int64_t i = 0; i < size; ++i)
+                MapDesc_::Insert(m, keys.KeyAt(i), i);
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef BENCHMARKS_SUITES_CONTAINERS_FLATMAP_HPP
+#define BENCHMARKS_SUITES_CONTAINERS_FLATMAP_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace suites
+{
+    namespace containers
+    {
+
+        // Sorted vector of key-value pairs, logarithmic lookups and linear inserts/erases
+        class FlatMap
+        {
+            using Entry = std::pair<int64_t, int64_t>;
+
+        private:
+            std::vector<Entry>      _entries;
+
+        public:
+            size_t GetSize() const { return _entries.size(); }
+
+            bool Insert(int64_t key, int64_t value)
+            {
+                auto it = LowerBound(key);
+                if (it != _entries.end() && it->first == key)
+                    return false;
+                _entries.insert(it, Entry(key, value));
+                return true;
+            }
+
+            const int64_t* Find(int64_t key) const
+            {
+                auto it = LowerBound(key);
+                return (it != _entries.end() && it->first == key) ? &it->second : nullptr;
+            }
+
+            bool Erase(int64_t key)
+            {
+                auto it = LowerBound(key);
+                if (it == _entries.end() || it->first != key)
+                    return false;
+                _entries.erase(it);
+                return true;
+            }
+
+            template < typename Functor_ >
+            void ForEach(const Functor_& func) const
+            {
+                for (const auto& e : _entries)
+                    func(e.first, e.second);
+            }
+
+        private:
+            std::vector<Entry>::iterator LowerBound(int64_t key)
+            { return std::lower_bound(_entries.begin(), _entries.end(), key, [](const Entry& e, int64_t k) { return e.first < k; }); }
+
+            std::vector<Entry>::const_iterator LowerBound(int64_t key) const
+            { return std::lower_bound(_entries.begin(), _entries.end(), key, [](const Entry& e, int64_t k) { return e.first < k; }); }
+        };
+
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef BENCHMARKS_SUITES_CONTAINERS_KEYDISTRIBUTION_HPP
+#define BENCHMARKS_SUITES_CONTAINERS_KEYDISTRIBUTION_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace suites
+{
+    namespace containers
+    {
+
+        // The keys of an N-element container are KeyAt(i) for i in [0, N), the distribution decides both the keys and the
+        // order the lookups access them in:
+        //   sequential - consecutive keys accessed in ascending order
+        //   uniform    - scattered keys accessed uniformly at random
+        //   zipf       - scattered keys, a few of them accessed much more often than the rest (Zipf's law, s = 0.99)
+        // Inserts and erases touch every key once in the order of indices, which is random for the scattered keys
+        class KeyDistribution
+        {
+        public:
+            enum class Kind
+            {
+                Sequential,
+                Uniform,
+                Zipf
+            };
+
+        private:
+            Kind        _kind;
+
+        public:
+            KeyDistribution(Kind kind = Kind::Uniform) : _kind(kind) { }
+
+            static KeyDistribution Parse(const std::string& str)
+            {
+                if (str == "sequential")
+                    return KeyDistribution(Kind::Sequential);
+                if (str == "uniform")
+                    return KeyDistribution(Kind::Uniform);
+                if (str == "zipf")
+                    return KeyDistribution(Kind::Zipf);
+                throw std::runtime_error("Unknown key distribution: '" + str + "'");
+            }
+
+            Kind GetKind() const { return _kind; }
+
+            int64_t KeyAt(int64_t index) const
+            {
+                if (_kind == Kind::Sequential)
+                    return index;
+
+                // A bijection, so the distinct indices give distinct keys
+                uint64_t x = (uint64_t)index;
+                x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+                return (int64_t)(x ^ (x >> 31));
+            }
+
+            // Indices in [0, size) in the access order of this distribution
+            std::vector<int64_t> GetAccessIndices(int64_t size, int64_t count, uint32_t seed = 0) const
+            {
+                std::vector<int64_t> result(count);
+                std::mt19937_64 rng(seed);
+                switch (_kind)
+                {
+                case Kind::Sequential:
+                    for (int64_t i = 0; i < count; ++i)
+                        result[i] = i % size;
+                    break;
+                case Kind::Uniform:
+                    {
+                        std::uniform_int_distribution<int64_t> d(0, size - 1);
+                        for (auto& r : result)
+                            r = d(rng);
+                    }
+                    break;
+                case Kind::Zipf:
+                    {
+                        std::vector<double> cdf(size);
+                        double sum = 0;
+                        for (int64_t i = 0; i < size; ++i)
+                            cdf[i] = (sum += 1 / std::pow((double)(i + 1), 0.99));
+
+                        // The most popular ranks are spread over the key space
+                        std::vector<int64_t> ranks(size);
+                        std::iota(ranks.begin(), ranks.end(), 0);
+                        std::shuffle(ranks.begin(), ranks.end(), rng);
+
+                        std::uniform_real_distribution<double> d(0, sum);
+                        for (auto& r : result)
+                            r = ranks[std::min<int64_t>(std::lower_bound(cdf.begin(), cdf.end(), d(rng)) - cdf.begin(), size - 1)];
+                    }
+                    break;
+                }
+                return result;
+            }
+
+            std::string ToString() const
+            {
+                switch (_kind)
+                {
+                case Kind::Sequential: return "sequential";
+                case Kind::Uniform: return "uniform";
+                case Kind::Zipf: return "zipf";
+                }
+                return "unknown";
+            }
+        };
+
+        inline std::istream& operator >> (std::istream& s, KeyDistribution& distribution)
+        {
+            std::string str;
+            s >> str;
+            distribution = KeyDistribution::Parse(str);
+            return s;
+        }
+
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef BENCHMARKS_SUITES_CONTAINERS_OPENADDRESSINGMAP_HPP
+#define BENCHMARKS_SUITES_CONTAINERS_OPENADDRESSINGMAP_HPP
+
+
+// Copyright (c) 2016, Dmitry Koplyarov <koplyarov.da@gmail.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose with or without fee is hereby granted,
+// provided that the above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+// WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace suites
+{
+    namespace containers
+    {
+
+        // Linear probing hash map with Fibonacci hashing, erased slots are marked as deleted until the next rehash
+        class OpenAddressingMap
+        {
+            static const size_t MinCapacity = 16;
+
+            enum class SlotState : uint8_t
+            {
+                Empty,
+                Occupied,
+                Deleted
+            };
+
+            struct Slot
+            {
+                int64_t     key;
+                int64_t     value;
+            };
+
+        private:
+            std::vector<Slot>       _slots;
+            std::vector<SlotState>  _states;
+            int                     _shift;
+            size_t                  _size;
+            size_t                  _deleted;
+
+        public:
+            OpenAddressingMap()
+                : _slots(MinCapacity), _states(MinCapacity, SlotState::Empty), _shift(64 - 4), _size(0), _deleted(0)
+            { }
+
+            size_t GetSize() const { return _size; }
+
+            bool Insert(int64_t key, int64_t value)
+            {
+                // The load factor (including the deleted slots) is kept below 3/4
+                if ((_size + _deleted + 1) * 4 > _slots.size() * 3)
+                    Rehash(_size * 2 + 2 > _slots.size() / 2 ? _slots.size() * 2 : _slots.size());
+
+                size_t mask = _slots.size() - 1;
+                size_t insert_pos = _slots.size();
+                for (size_t i = GetHomeSlot(key); ; i = (i + 1) & mask)
+                {
+                    if (_states[i] == SlotState::Empty)
+                    {
+                        if (insert_pos == _slots.size())
+                            insert_pos = i;
+                        break;
+                    }
+                    if (_states[i] == SlotState::Deleted)
+                    {
+                        if (insert_pos == _slots.size())
+                            insert_pos = i;
+                    }
+                    else if (_slots[i].key == key)
+                        return false;
+                }
+
+                if (_states[insert_pos] == SlotState::Deleted)
+                    --_deleted;
+                _states[insert_pos] = SlotState::Occupied;
+                _slots[insert_pos].key = key;
+                _slots[insert_pos].value = value;
+                ++_size;
+                return true;
+            }
+
+            const int64_t* Find(int64_t key) const
+            {
+                size_t pos = FindSlot(key);
+                return pos == _slots.size() ? nullptr : &_slots[pos].value;
+            }
+
+            bool Erase(int64_t key)
+            {
+                size_t pos = FindSlot(key);
+                if (pos == _slots.size())
+                    return false;
+                _states[pos] = SlotState::Deleted;
+                --_size;
+                ++_deleted;
+                return true;
+            }
+
+            template < typename Functor_ >
+            void ForEach(const Functor_& func) const
+            {
+                for (size_t i = 0; i < _slots.size(); ++i)
+                    if (_states[i] == SlotState::Occupied)
+                        func(_slots[i].key, _slots[i].value);
+            }
+
+        private:
+            size_t GetHomeSlot(int64_t key) const
+            { return (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> _shift); }
+
+            size_t FindSlot(int64_t key) const
+            {
+                size_t mask = _slots.size() - 1;
+                for (size_t i = GetHomeSlot(key); _states[i] != SlotState::Empty; i = (i + 1) & mask)
+                    if (_states[i] == SlotState::Occupied && _slots[i].key == key)
+                        return i;
+                return _slots.size();
+            }
+
+            void Rehash(size_t capacity)
+            {
+                std::vector<Slot> slots(capacity);
+                std::vector<SlotState> states(capacity, SlotState::Empty);
+                slots.swap(_slots);
+                states.swap(_states);
+
+                _shift = 64;
+                for (size_t c = capacity; c > 1; c /= 2)
+                    --_shift;
+                _size = 0;
+                _deleted = 0;
+                for (size_t i = 0; i < slots.size(); ++i)
+                    if (states[i] == SlotState::Occupied)
+                        Insert(slots[i].key, slots[i].value);
+            }
+        };
+
+    }
+}
+
+#endif